@@ -1,4 +1,5 @@
 #include "apk/apkcloner.h"
+#include "base/searchindex.h"
 #include <QDirIterator>
 #include <QtConcurrent/QtConcurrent>
 
@@ -15,6 +16,11 @@ ApkCloner::ApkCloner(const QString &contentsPath, const QString &originalPackage
     originalPackagePath.replace('.', '/');
 }
 
+void ApkCloner::setSearchIndex(SearchIndex *index)
+{
+    searchIndex = index;
+}
+
 void ApkCloner::start()
 {
     QtConcurrent::run([this]() {
@@ -36,6 +42,8 @@ void ApkCloner::start()
                 if (newData != data) {
                     file.resize(0);
                     file.write(newData.toUtf8());
+                    file.flush();
+                    updateSearchIndex(path);
                 }
                 file.close();
             }
@@ -54,6 +62,8 @@ void ApkCloner::start()
             if (newData != data) {
                 file.resize(0);
                 file.write(newData.toUtf8());
+                file.flush();
+                updateSearchIndex(manifestPath);
             }
             file.close();
         }
@@ -82,6 +92,8 @@ void ApkCloner::start()
                     if (newData != data) {
                         file.resize(0);
                         file.write(newData.toUtf8());
+                        file.flush();
+                        updateSearchIndex(path);
                     }
                     file.close();
                 }
@@ -101,8 +113,18 @@ void ApkCloner::start()
                 emit finished(false);
                 return;
             }
+            if (searchIndex) {
+                searchIndex->rename(fullOriginalPackagePath, fullPackagePath);
+            }
         }
 \
         emit finished(true);
     });
 }
+
+void ApkCloner::updateSearchIndex(const QString &path)
+{
+    if (searchIndex) {
+        searchIndex->update(path);
+    }
+}
@@ -3,6 +3,8 @@
 
 #include <QObject>
 
+class SearchIndex;
+
 class ApkCloner : public QObject
 {
     Q_OBJECT
@@ -11,6 +13,7 @@ public:
     explicit ApkCloner(const QString &contentsPath, const QString &originalPackageName,
                        const QString &newPackageName, QObject *parent = nullptr);
 
+    void setSearchIndex(SearchIndex *index);
     void start();
 
 signals:
@@ -19,11 +22,14 @@ signals:
     void finished(bool success);
 
 private:
+    void updateSearchIndex(const QString &path);
+
     QString contentsPath;
     QString originalPackageName;
     QString originalPackagePath;
     QString newPackageName;
     QString newPackagePath;
+    SearchIndex *searchIndex = nullptr;
 };
 
 #endif // APKCLONER_H
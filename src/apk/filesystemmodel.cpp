@@ -15,10 +15,17 @@ void FileSystemModel::setSourceModel(ResourceItemsModel *model)
     if (model) {
         connect(model, &ResourceItemsModel::dataChanged, this,
                 [=](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles) {
-            const auto fromIndex = index(ResourceModelIndex(topLeft).path());
-            const auto toIndex = index(ResourceModelIndex(bottomRight).path());
-            updated(fromIndex.sibling(fromIndex.row(), 0),
-                      toIndex.sibling(toIndex.row(), columnCount() - 1), roles);
+            if (ResourceItemsModel::isThumbnailUpdate(roles)) {
+                return; // Resource thumbnails are not displayed by the file system model
+            }
+            // Adjacent resource rows might be files of different directories, so each row is mapped on its own:
+            for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+                const auto fileIndex = index(ResourceModelIndex(topLeft.sibling(row, 0)).path());
+                if (fileIndex.isValid()) {
+                    updated(fileIndex.sibling(fileIndex.row(), 0),
+                            fileIndex.sibling(fileIndex.row(), columnCount() - 1), roles);
+                }
+            }
         });
     }
 }
@@ -5,6 +5,8 @@
 #include "base/utils.h"
 #include <QDebug>
 #include <QDir>
+#include <QImage>
+#include <QSet>
 
 IconItemsModel::IconItemsModel(QObject *parent) : QAbstractProxyModel(parent)
 {
@@ -43,29 +45,76 @@ void IconItemsModel::setSourceModel(QAbstractItemModel *newSourceModel)
 
 void IconItemsModel::setManifestScopes(const QList<ManifestScope *> &scopes)
 {
-    this->scopes = scopes;
+    // Map icon resources to the scopes which use them:
+    scopeIcons.clear();
+    for (ManifestScope *scope : scopes) {
+        const ManifestAttribute attributes[] = {scope->icon(), scope->roundIcon(), scope->banner()};
+        const IconType iconTypes[] = {TypeIcon, TypeRoundIcon, TypeBanner};
+        QSet<QPair<QString, QString>> scopeResources;
+        for (int i = 0; i < 3; ++i) {
+            const auto resource = qMakePair(attributes[i].getResourceType(), attributes[i].getResourceName());
+            // A resource used as several icons of the same scope is only listed once, as its first icon type:
+            if (!resource.first.isEmpty() && !resource.second.isEmpty() && !scopeResources.contains(resource)) {
+                scopeResources.insert(resource);
+                scopeIcons[resource].append({scope, iconTypes[i]});
+            }
+        }
+    }
+
     sourceModelReset();
 }
 
-ResourceItemsModel *IconItemsModel::sourceModel() const
+QIcon IconItemsModel::composeApplicationIcon() const
 {
-    return static_cast<ResourceItemsModel *>(QAbstractProxyModel::sourceModel());
-}
-
-QIcon IconItemsModel::getIcon() const
-{
-    QIcon icon;
+    // Load full-size images, as resource thumbnails are decoded asynchronously at a small size:
+    QVector<QImage> images;
     const auto iconNodes = applicationNode->getChildren();
     for (auto node : iconNodes) {
         auto iconNode = static_cast<IconNode *>(node);
         if (iconNode->iconType == TypeIcon) {
-            const QPixmap pixmap = Utils::iconToPixmap(proxyToSourceMap.value(iconNode).data(Qt::DecorationRole).value<QIcon>());
-            icon.addPixmap(pixmap);
+            const QModelIndex sourceIndex = proxyToSourceMap.value(iconNode);
+            const QImage image(sourceIndex.sibling(sourceIndex.row(), ResourceItemsModel::PathColumn).data().toString());
+            if (!image.isNull()) {
+                images.append(image);
+            }
+        }
+    }
+    if (images.isEmpty()) {
+        return QIcon();
+    }
+
+    // Compose the icon at the sizes it is displayed at (package list, recent files, menus):
+    QIcon icon;
+    for (const int size : {16, 24, 32, 48}) {
+        const QSize iconSize = Utils::scale(size, size);
+        // Prefer the smallest image which covers the size, otherwise the largest one:
+        const QImage *source = &images.first();
+        for (const QImage &image : qAsConst(images)) {
+            const bool isCovering = image.width() >= iconSize.width() && image.height() >= iconSize.height();
+            const bool isSourceCovering = source->width() >= iconSize.width() && source->height() >= iconSize.height();
+            if (isCovering ? (!isSourceCovering || image.width() < source->width()) : (!isSourceCovering && image.width() > source->width())) {
+                source = &image;
+            }
         }
+        icon.addPixmap(QPixmap::fromImage(source->scaled(iconSize, Qt::KeepAspectRatio, Qt::SmoothTransformation)));
     }
     return icon;
 }
 
+ResourceItemsModel *IconItemsModel::sourceModel() const
+{
+    return static_cast<ResourceItemsModel *>(QAbstractProxyModel::sourceModel());
+}
+
+QIcon IconItemsModel::getIcon() const
+{
+    if (!isApplicationIconValid) {
+        applicationIcon = composeApplicationIcon();
+        isApplicationIconValid = true;
+    }
+    return applicationIcon;
+}
+
 QIcon IconItemsModel::getIcon(const QModelIndex &index) const
 {
     const QModelIndex sourceIndex = mapToSource(index);
@@ -119,21 +168,17 @@ bool IconItemsModel::replaceApplicationIcons(const QString &path, QWidget *paren
     if (path.isEmpty()) {
         return false;
     }
-    bool success = false;
+    QModelIndexList sourceIndexes;
     auto applicationIndex = index(ApplicationRow, 0);
     auto applicationIconCount = applicationNode->childCount();
     for (int row = 0; row < applicationIconCount; ++row) {
         auto iconIndex = index(row, PathColumn, applicationIndex);
         auto iconType = getIconType(iconIndex);
         if (iconType == TypeIcon || iconType == TypeRoundIcon) {
-            if (Utils::isImageWritable(getIconPath(iconIndex))) {
-                if (!sourceModel()->replaceResource(mapToSource(iconIndex), path, parent)) {
-                    success = false;
-                }
-            }
+            sourceIndexes.append(mapToSource(iconIndex));
         }
     }
-    return success;
+    return sourceModel()->replaceImages(sourceIndexes, path, parent);
 }
 
 bool IconItemsModel::replaceResource(const QModelIndex &index, const QString &path, QWidget *parent)
@@ -244,24 +289,28 @@ void IconItemsModel::sort(int column, Qt::SortOrder order)
     const QList<QPersistentModelIndex> rootIndexes{applicationIndex, activitiesIndex};
     emit layoutAboutToBeChanged(rootIndexes, QAbstractItemModel::VerticalSortHint);
 
-    auto comparator = [this](TreeNode *node1, TreeNode *node2) -> bool {
-        auto icon1 = static_cast<IconNode *>(node1);
-        auto icon2 = static_cast<IconNode *>(node2);
-        auto index1 = proxyToSourceMap.value(icon1);
-        auto index2 = proxyToSourceMap.value(icon2);
-        const bool swap = ![&]() -> bool {
-            if (icon1->iconType < icon2->iconType) { return true; }
-            if (icon2->iconType < icon1->iconType) { return false; }
-            auto dpi1 = index1.sibling(index1.row(), ResourceItemsModel::DpiColumn).data(ResourceItemsModel::SortRole);
-            auto dpi2 = index2.sibling(index2.row(), ResourceItemsModel::DpiColumn).data(ResourceItemsModel::SortRole);
-            if (dpi1 < dpi2) { return true; }
-            if (dpi2 < dpi1) { return false; }
-            return false;
-        }();
-        if (swap) {
-            changePersistentIndex(mapFromSource(index1), mapFromSource(index2));
+    const QModelIndexList oldIndexes = persistentIndexList();
+    sortNodes();
+    QModelIndexList newIndexes;
+    newIndexes.reserve(oldIndexes.count());
+    for (const QModelIndex &oldIndex : oldIndexes) {
+        auto node = static_cast<TreeNode *>(oldIndex.internalPointer());
+        newIndexes.append(createIndex(node->row(), oldIndex.column(), node));
+    }
+    changePersistentIndexList(oldIndexes, newIndexes);
+
+    emit layoutChanged(rootIndexes, QAbstractItemModel::VerticalSortHint);
+}
+
+void IconItemsModel::sortNodes()
+{
+    auto comparator = [](const TreeNode *node1, const TreeNode *node2) -> bool {
+        auto icon1 = static_cast<const IconNode *>(node1);
+        auto icon2 = static_cast<const IconNode *>(node2);
+        if (icon1->iconType != icon2->iconType) {
+            return icon1->iconType < icon2->iconType;
         }
-        return !swap;
+        return icon1->dpiRank < icon2->dpiRank;
     };
 
     auto &applicationIcons = applicationNode->getChildren();
@@ -278,8 +327,6 @@ void IconItemsModel::sort(int column, Qt::SortOrder order)
         auto &activityIcons = activityNode->getChildren();
         std::sort(activityIcons.begin(), activityIcons.end(), comparator);
     }
-
-    emit layoutChanged(rootIndexes, QAbstractItemModel::VerticalSortHint);
 }
 
 int IconItemsModel::rowCount(const QModelIndex &parent) const
@@ -316,17 +363,25 @@ bool IconItemsModel::removeRows(int row, int count, const QModelIndex &parent)
 
 bool IconItemsModel::appendIcon(const QPersistentModelIndex &iconIndex, ManifestScope *scope, IconType iconType)
 {
+    // Rows are not announced while the model is being populated as a whole (see sourceModelReset()):
+
     if (!sourceToProxyMap.contains(iconIndex)) {
+        const auto resource = sourceModel()->getResourceFile(iconIndex);
+        const int dpiRank = resource ? resource->getDpiRank() : 0;
         switch (scope->type()) {
         case ManifestScope::Type::Application: {
             const int row = applicationNode->childCount();
-            beginInsertRows(index(ApplicationRow, 0), row, row);
-                auto iconNode = new IconNode(iconType);
-                applicationNode->addChild(iconNode);
-                sourceToProxyMap.insert(iconIndex, iconNode);
-                proxyToSourceMap.insert(iconNode, iconIndex);
-            endInsertRows();
-            sort();
+            if (!populating) {
+                beginInsertRows(index(ApplicationRow, 0), row, row);
+            }
+            auto iconNode = new IconNode(iconType, dpiRank);
+            applicationNode->addChild(iconNode);
+            isApplicationIconValid = false;
+            sourceToProxyMap.insert(iconIndex, iconNode);
+            proxyToSourceMap.insert(iconNode, iconIndex);
+            if (!populating) {
+                endInsertRows();
+            }
             return true;
         }
         case ManifestScope::Type::Activity: {
@@ -343,20 +398,27 @@ bool IconItemsModel::appendIcon(const QPersistentModelIndex &iconIndex, Manifest
             if (!activityNode) {
                 // Create new activity node:
                 const int row = activitiesNode->childCount();
-                beginInsertRows(index(ActivitiesRow, 0), row, row);
-                    activityNode = new ActivityNode(scope);
-                    activitiesNode->addChild(activityNode);
-                endInsertRows();
+                if (!populating) {
+                    beginInsertRows(index(ActivitiesRow, 0), row, row);
+                }
+                activityNode = new ActivityNode(scope);
+                activitiesNode->addChild(activityNode);
+                if (!populating) {
+                    endInsertRows();
+                }
             }
-            const QModelIndex activityIndex = index(activityNode->row(), 0, index(ActivitiesRow, 0));
             const int row = activityNode->childCount();
-            beginInsertRows(activityIndex, row, row);
-                auto iconNode = new IconNode(iconType);
-                activityNode->addChild(iconNode);
-                sourceToProxyMap.insert(iconIndex, iconNode);
-                proxyToSourceMap.insert(iconNode, iconIndex);
-            endInsertRows();
-            sort();
+            if (!populating) {
+                const QModelIndex activityIndex = index(activityNode->row(), 0, index(ActivitiesRow, 0));
+                beginInsertRows(activityIndex, row, row);
+            }
+            auto iconNode = new IconNode(iconType, dpiRank);
+            activityNode->addChild(iconNode);
+            sourceToProxyMap.insert(iconIndex, iconNode);
+            proxyToSourceMap.insert(iconNode, iconIndex);
+            if (!populating) {
+                endInsertRows();
+            }
             return true;
         }
         }
@@ -364,35 +426,35 @@ bool IconItemsModel::appendIcon(const QPersistentModelIndex &iconIndex, Manifest
     return false;
 }
 
-void IconItemsModel::populateFromSource(const QModelIndex &parent)
-{
-    const int rows = sourceModel()->rowCount(parent);
-    sourceRowsInserted(parent, 0, rows);
-    for (int row = 0; row < rows; ++row) {
-        populateFromSource(sourceModel()->index(row, 0, parent));
-    }
-}
-
-void IconItemsModel::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+bool IconItemsModel::appendIcons(const QModelIndex &parent, int first, int last)
 {
+    bool appended = false;
     for (int row = first; row <= last; ++row) {
         const auto index = sourceModel()->index(row, 0, parent);
         const auto resource = sourceModel()->getResourceFile(index);
-        if (resource && Utils::isDrawableResource(resource->getFilePath())) {
-            auto resourceName = resource->getName();
-            auto resourceType = resource->getType();
-            if (!resourceName.isEmpty() && !resourceType.isEmpty()) {
-                for (ManifestScope *scope : qAsConst(scopes)) {
-                    if (resourceName == scope->icon().getResourceName() && resourceType == scope->icon().getResourceType()) {
-                        appendIcon(index, scope, TypeIcon);
-                    } else if (resourceName == scope->roundIcon().getResourceName() && resourceType == scope->roundIcon().getResourceType()) {
-                        appendIcon(index, scope, TypeRoundIcon);
-                    } else if (resourceName == scope->banner().getResourceName() && resourceType == scope->banner().getResourceType()) {
-                        appendIcon(index, scope, TypeBanner);
+        if (resource) {
+            const auto it = scopeIcons.constFind(qMakePair(resource->getType(), resource->getName()));
+            if (it != scopeIcons.constEnd() && Utils::isDrawableResource(resource->getFilePath())) {
+                for (const ScopeIcon &scopeIcon : it.value()) {
+                    if (appendIcon(index, scopeIcon.scope, scopeIcon.iconType)) {
+                        appended = true;
                     }
                 }
             }
         }
+        // Resource groups are inserted along with their files:
+        const int childCount = sourceModel()->rowCount(index);
+        if (childCount > 0 && appendIcons(index, 0, childCount - 1)) {
+            appended = true;
+        }
+    }
+    return appended;
+}
+
+void IconItemsModel::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (appendIcons(parent, first, last)) {
+        sort();
     }
 }
 
@@ -405,27 +467,58 @@ void IconItemsModel::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int f
             auto proxyRow = proxyIndex.row();
             beginRemoveRows(proxyIndex.parent(), proxyRow, proxyRow);
                 auto proxyNode = sourceToProxyMap.value(sourceIndex);
+                if (proxyNode->getParent() == applicationNode) {
+                    isApplicationIconValid = false;
+                }
                 proxyNode->removeSelf();
                 proxyToSourceMap.remove(proxyNode);
                 sourceToProxyMap.remove(sourceIndex);
             endRemoveRows();
         }
+        // Resource groups are removed along with their files:
+        const int childCount = sourceModel()->rowCount(sourceIndex);
+        if (childCount > 0) {
+            sourceRowsAboutToBeRemoved(sourceIndex, 0, childCount - 1);
+        }
     }
 }
 
-void IconItemsModel::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+void IconItemsModel::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
 {
-    emit dataChanged(mapFromSource(topLeft), mapFromSource(bottomRight));
+    // Icons are mapped by their source rows, and the proxy columns don't correspond to the source ones.
+    // Adjacent source rows might also be far apart in the proxy, so every row is notified on its own:
+    const bool isThumbnailUpdate = ResourceItemsModel::isThumbnailUpdate(roles);
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const QModelIndex proxyIndex = mapFromSource(topLeft.sibling(row, 0));
+        if (!proxyIndex.isValid()) {
+            continue;
+        }
+        // Decoded thumbnails come with a decoration-only change, the application icon is composed from the files:
+        if (!isThumbnailUpdate && proxyIndex.parent() == index(ApplicationRow, 0)) {
+            isApplicationIconValid = false;
+        }
+        emit dataChanged(proxyIndex, proxyIndex.sibling(proxyIndex.row(), ColumnCount - 1), roles);
+    }
 }
 
 void IconItemsModel::sourceModelReset()
 {
     beginResetModel();
+    isApplicationIconValid = false;
     sourceToProxyMap.clear();
     proxyToSourceMap.clear();
     applicationNode->removeChildren();
     activitiesNode->removeChildren();
-    populateFromSource();
+
+    // Collect all the icons first and sort them once:
+    populating = true;
+    const int rows = sourceModel()->rowCount();
+    if (rows > 0) {
+        appendIcons({}, 0, rows - 1);
+    }
+    populating = false;
+    sortNodes();
+
     endResetModel();
 }
 
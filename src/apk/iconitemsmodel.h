@@ -2,6 +2,7 @@
 #define ICONITEMSMODEL_H
 
 #include <QAbstractProxyModel>
+#include <QIcon>
 #include "apk/resourceitemsmodel.h"
 #include "base/treenode.h"
 
@@ -64,9 +65,10 @@ public:
 private:
     struct IconNode : public TreeNode
     {
-        IconNode(IconType iconType) : iconType(iconType) {}
+        IconNode(IconType iconType, int dpiRank) : iconType(iconType), dpiRank(dpiRank) {}
         void addChild(TreeNode *node) = delete;
         const IconType iconType;
+        const int dpiRank;
     };
 
     struct ActivityNode : public TreeNode
@@ -76,19 +78,30 @@ private:
         const ManifestScope *scope;
     };
 
+    struct ScopeIcon
+    {
+        ManifestScope *scope;
+        IconType iconType;
+    };
+
+    QIcon composeApplicationIcon() const;
     bool appendIcon(const QPersistentModelIndex &index, ManifestScope *scope, IconType type = TypeIcon);
-    void populateFromSource(const QModelIndex &parent = {});
+    bool appendIcons(const QModelIndex &parent, int first, int last);
+    void sortNodes();
     void sourceRowsInserted(const QModelIndex &parent, int first, int last);
     void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
-    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
     void sourceModelReset();
 
-    QList<ManifestScope *> scopes;
+    QHash<QPair<QString, QString>, QVector<ScopeIcon>> scopeIcons; // (Type, name) to icons
     QHash<QPersistentModelIndex, IconNode *> sourceToProxyMap;
     QHash<IconNode *, QPersistentModelIndex> proxyToSourceMap;
     TreeNode *root;
     TreeNode *applicationNode;
     TreeNode *activitiesNode;
+    bool populating = false;
+    mutable QIcon applicationIcon;
+    mutable bool isApplicationIconValid = false;
 };
 
 #endif // ICONITEMSMODEL_H
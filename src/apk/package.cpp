@@ -25,6 +25,7 @@ Package::Package(const QString &path)
 Package::~Package()
 {
     delete manifest;
+    searchIndex.clear();
 
     if (!contentsPath.isEmpty()) {
         qDebug() << qPrintable(QString("Removing \"%1\"...\n").arg(contentsPath));
@@ -83,6 +84,7 @@ void Package::setPackageName(const QString &packageName)
     }
 
     auto cloner = new ApkCloner(getContentsPath(), getPackageName(), packageName, this);
+    cloner->setSearchIndex(&searchIndex);
     connect(cloner, &ApkCloner::started, this, &Package::cloningStarted);
     connect(cloner, &ApkCloner::progressed, this, &Package::cloningProgressed);
     connect(cloner, &ApkCloner::finished, this, &Package::cloningFinished);
@@ -155,14 +157,43 @@ Command *Package::createUnpackCommand()
     });
     connect(command, &Command::finished, this, [=](bool success) {
         if (success) {
-            connect(&resourcesModel, &ResourceItemsModel::dataChanged, this, [=]() {
-                state.setModified(true);
+            connect(&resourcesModel, &ResourceItemsModel::dataChanged, this,
+                    [=](const QModelIndex &, const QModelIndex &, const QVector<int> &roles) {
+                if (!ResourceItemsModel::isThumbnailUpdate(roles)) {
+                    state.setModified(true);
+                }
             });
             connect(&filesystemModel, &QFileSystemModel::dataChanged, this, [=]() {
                 state.setModified(true);
             });
-            connect(&iconsProxy, &IconItemsModel::dataChanged, this, [=]() {
-                state.setModified(true);
+            // Keep the search index in sync with the replaced files:
+            connect(&resourcesModel, &ResourceItemsModel::dataChanged, this,
+                    [=](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles) {
+                if (ResourceItemsModel::isThumbnailUpdate(roles)) {
+                    return;
+                }
+                // Every row is resolved to its own file (group and type rows have no path):
+                for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+                    const QString path = resourcesModel.getResourcePath(topLeft.sibling(row, 0));
+                    if (!path.isEmpty()) {
+                        searchIndex.update(path);
+                    }
+                }
+            });
+            connect(&filesystemModel, &QFileSystemModel::dataChanged, this,
+                    [=](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+                for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+                    const QModelIndex index = topLeft.sibling(row, 0);
+                    if (index.isValid() && !filesystemModel.isDir(index)) {
+                        searchIndex.update(filesystemModel.filePath(index));
+                    }
+                }
+            });
+            connect(&iconsProxy, &IconItemsModel::dataChanged, this,
+                    [=](const QModelIndex &, const QModelIndex &, const QVector<int> &roles) {
+                if (!ResourceItemsModel::isThumbnailUpdate(roles)) {
+                    state.setModified(true);
+                }
             });
             connect(&manifestModel, &ManifestModel::dataChanged, this,
                     [=](const QModelIndex &, const QModelIndex &, const QVector<int> &roles) {
@@ -273,6 +304,7 @@ void Package::LoadUnpackedCommand::run()
     auto initResourcesFuture = package->resourcesModel.initialize(contentsPath + "/res/");
     auto initResourcesFutureWatcher = new QFutureWatcher<void>(this);
     connect(initResourcesFutureWatcher, &QFutureWatcher<void>::finished, this, [=]() {
+        package->searchIndex.build(contentsPath, &package->searchClassifier);
         emit finished(true);
     });
     initResourcesFutureWatcher->setFuture(initResourcesFuture);
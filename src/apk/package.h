@@ -8,6 +8,8 @@
 #include "apk/packagestate.h"
 #include "apk/resourceitemsmodel.h"
 #include "base/command.h"
+#include "base/searchfileclassifier.h"
+#include "base/searchindex.h"
 #include <QIcon>
 
 class Keystore;
@@ -38,6 +40,8 @@ public:
     IconItemsModel iconsProxy;
     ManifestModel manifestModel;
     LogModel logModel;
+    SearchFileClassifier searchClassifier;
+    SearchIndex searchIndex;
 
     Commands *createCommandChain();
     Command *createUnpackCommand();
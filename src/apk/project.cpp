@@ -202,6 +202,8 @@ void Project::openSearchTab()
 
     auto tab = new SearchSheet(parentWidget());
     tab->setSearchPath(package->getContentsPath());
+    tab->setFileClassifier(&package->searchClassifier);
+    tab->setSearchIndex(&package->searchIndex);
     tab->setProperty("identifier", identifier);
     connect(tab, &SearchSheet::editRequested, this, &Project::openCodeSheetTab);
     addTab(tab);
@@ -343,9 +345,15 @@ int Project::addTab(BaseSheet *tab)
     tabWidget->setCurrentIndex(tabIndex);
     auto editor = qobject_cast<BaseEditableSheet *>(tab);
     if (editor) {
-        connect(editor, &BaseEditableSheet::saved, this, [this]() {
+        connect(editor, &BaseEditableSheet::saved, this, [this, editor]() {
             // Project save indicator:
             const_cast<PackageState &>(package->getState()).setModified(true);
+            // Search index:
+            auto fileSheet = qobject_cast<BaseFileSheet *>(editor);
+            if (fileSheet) {
+                package->searchIndex.update(fileSheet->getFilePath());
+                package->resourcesModel.updateThumbnail(fileSheet->getFilePath());
+            }
         });
         connect(editor, &BaseEditableSheet::modifiedStateChanged, this, [=](bool modified) {
             // Tab save indicator:
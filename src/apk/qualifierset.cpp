@@ -0,0 +1,216 @@
+#include "apk/qualifierset.h"
+#include "base/utils.h"
+#include <QHash>
+#include <QLocale>
+#include <QReadWriteLock>
+#include <QStringList>
+
+namespace Qualifiers
+{
+    enum Type {
+        LayoutDirection,
+        SmallestWidth,
+        AvailableWidth,
+        AvailableHeight,
+        ScreenSize,
+        ScreenAspect,
+        RoundScreen,
+        WideColorGamut,
+        Hdr,
+        ScreenOrientation,
+        UiMode,
+        NightMode,
+        Dpi,
+        TouchscreenType,
+        KeyboardAvailability,
+        InputMethod,
+        NavigationAvailability,
+        NavigationMethod,
+        ApiVersion,
+        Locale,
+        TypeCount
+    };
+
+    // Read more: https://developer.android.com/guide/topics/resources/providing-resources.html?hl=en
+    const QHash<QString, Type> table = {
+        {"ldrtl", LayoutDirection}, {"ldltr", LayoutDirection},
+        {"small", ScreenSize}, {"normal", ScreenSize}, {"large", ScreenSize}, {"xlarge", ScreenSize},
+        {"long", ScreenAspect}, {"notlong", ScreenAspect},
+        {"round", RoundScreen}, {"notround", RoundScreen},
+        {"widecg", WideColorGamut}, {"nowidecg", WideColorGamut},
+        {"highdr", Hdr}, {"lowdr", Hdr},
+        {"port", ScreenOrientation}, {"land", ScreenOrientation},
+        {"car", UiMode}, {"desk", UiMode}, {"television", UiMode},
+        {"appliance", UiMode}, {"watch", UiMode}, {"vrheadset", UiMode},
+        {"night", NightMode}, {"notnight", NightMode},
+        {"ldpi", Dpi}, {"mdpi", Dpi}, {"hdpi", Dpi}, {"xhdpi", Dpi}, {"xxhdpi", Dpi},
+        {"xxxhdpi", Dpi}, {"nodpi", Dpi}, {"tvdpi", Dpi}, {"anydpi", Dpi},
+        {"notouch", TouchscreenType}, {"finger", TouchscreenType},
+        {"keysexposed", KeyboardAvailability}, {"keyshidden", KeyboardAvailability}, {"keyssoft", KeyboardAvailability},
+        {"nokeys", InputMethod}, {"qwerty", InputMethod}, {"12key", InputMethod},
+        {"navexposed", NavigationAvailability}, {"navhidden", NavigationAvailability},
+        {"nonav", NavigationMethod}, {"dpad", NavigationMethod}, {"trackball", NavigationMethod}, {"wheel", NavigationMethod},
+    };
+
+    // Matches "<prefix><digits><suffix>", e.g. "sw600dp" or "v21":
+    bool isNumeric(const QString &qualifier, QLatin1String prefix, QLatin1String suffix = QLatin1String(""))
+    {
+        const int digitsEnd = qualifier.size() - suffix.size();
+        if (digitsEnd <= prefix.size() || !qualifier.startsWith(prefix) || !qualifier.endsWith(suffix)) {
+            return false;
+        }
+        for (int i = prefix.size(); i < digitsEnd; ++i) {
+            const ushort c = qualifier.at(i).unicode();
+            if (c < '0' || c > '9') {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Matches the "r" region code prefix, e.g. "rUS":
+    bool isRegion(const QString &qualifier)
+    {
+        if (qualifier.size() != 3 || qualifier.at(0) != 'r') {
+            return false;
+        }
+        for (int i = 1; i < 3; ++i) {
+            const ushort c = qualifier.at(i).unicode();
+            if (!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Type classify(const QString &qualifier)
+    {
+        const auto it = table.constFind(qualifier);
+        if (it != table.constEnd()) {
+            return it.value();
+        }
+        if (isNumeric(qualifier, QLatin1String("sw"), QLatin1String("dp"))) {
+            return SmallestWidth;
+        }
+        if (isNumeric(qualifier, QLatin1String("w"), QLatin1String("dp"))) {
+            return AvailableWidth;
+        }
+        if (isNumeric(qualifier, QLatin1String("h"), QLatin1String("dp"))) {
+            return AvailableHeight;
+        }
+        if (isNumeric(qualifier, QLatin1String("v"))) {
+            return ApiVersion;
+        }
+        return Locale;
+    }
+
+    int dpiRank(const QString &dpi)
+    {
+        static const QHash<QString, int> ranks = {
+            {"ldpi", 0}, {"mdpi", 1}, {"hdpi", 2}, {"xhdpi", 3}, {"xxhdpi", 4},
+            {"xxxhdpi", 5}, {"nodpi", 6}, {"tvdpi", 7}, {"anydpi", 8},
+        };
+        return ranks.value(dpi.toLower(), 9);
+    }
+}
+
+QualifierSet::QualifierSet(const QString &directoryName) : qualifiers(directoryName)
+{
+    // Split qualifiers, merging the "-r" region code into the preceding language (e.g., "en-rUS" to "en_US"):
+
+    QStringList qualifiersParts;
+    int partStart = 0;
+    for (;;) {
+        int partEnd = qualifiers.indexOf('-', partStart);
+        if (partEnd == -1) {
+            partEnd = qualifiers.size();
+        }
+        const QString part = qualifiers.mid(partStart, partEnd - partStart);
+        if (partStart == 0) {
+            type = part;
+        } else if (qualifiersParts.count() > 0 && Qualifiers::isRegion(part)) {
+            qualifiersParts.last() += '_' + part.mid(1);
+        } else {
+            qualifiersParts.append(part);
+        }
+        if (partEnd == qualifiers.size()) {
+            break;
+        }
+        partStart = partEnd + 1;
+    }
+    readableQualifiers = qualifiersParts.join(" - ");
+
+    // Classify qualifiers:
+
+    QString *fields[Qualifiers::TypeCount] = {
+        &layoutDirection,
+        &smallestWidth,
+        &availableWidth,
+        &availableHeight,
+        &screenSize,
+        &screenAspect,
+        &roundScreen,
+        &wideColorGamut,
+        &hdr,
+        &screenOrientation,
+        &uiMode,
+        &nightMode,
+        &dpi,
+        &touchscreenType,
+        &keyboardAvailability,
+        &inputMethod,
+        &navigationAvailability,
+        &navigationMethod,
+        &apiVersion,
+        &locale,
+    };
+    for (const QString &qualifier : qAsConst(qualifiersParts)) {
+        *fields[Qualifiers::classify(qualifier)] = qualifier;
+    }
+
+    // Handle legacy locales:
+    if (locale == "iw") {
+        localeLegacy = "he";
+    } else if (locale == "ji") {
+        localeLegacy = "yi";
+    } else if (locale == "in") {
+        localeLegacy = "id";
+    } else {
+        localeLegacy = locale;
+    }
+
+    // Compute sort keys:
+    dpiRank = Qualifiers::dpiRank(dpi);
+    apiLevel = apiVersion.mid(1).toInt();
+    languageName = Utils::capitalize(QLocale(localeLegacy).nativeLanguageName());
+}
+
+QSharedPointer<const QualifierSet> QualifierSet::intern(const QString &directoryName)
+{
+    static QReadWriteLock lock;
+    static QHash<QString, QWeakPointer<const QualifierSet>> sets;
+    static int sweepThreshold = 64;
+
+    {
+        QReadLocker locker(&lock);
+        const auto set = sets.value(directoryName).toStrongRef();
+        if (set) {
+            return set;
+        }
+    }
+
+    QWriteLocker locker(&lock);
+    auto set = sets.value(directoryName).toStrongRef();
+    if (!set) {
+        // Drop the sets released by all their files (e.g., of the closed packages) once the table has doubled:
+        if (sets.count() >= sweepThreshold) {
+            for (auto it = sets.begin(); it != sets.end();) {
+                it = it.value().isNull() ? sets.erase(it) : it + 1;
+            }
+            sweepThreshold = qMax(64, sets.count() * 2);
+        }
+        set = QSharedPointer<const QualifierSet>(new QualifierSet(directoryName));
+        sets.insert(directoryName, set);
+    }
+    return set;
+}
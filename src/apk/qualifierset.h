@@ -0,0 +1,48 @@
+#ifndef QUALIFIERSET_H
+#define QUALIFIERSET_H
+
+#include <QSharedPointer>
+#include <QString>
+
+// Qualifiers parsed from a resource directory name (e.g., "drawable-en-rUS-xhdpi-v4").
+// Sets are interned, so all the files of the same directory share a single instance.
+
+struct QualifierSet
+{
+    explicit QualifierSet(const QString &directoryName);
+
+    static QSharedPointer<const QualifierSet> intern(const QString &directoryName);
+
+    QString qualifiers;
+    QString readableQualifiers;
+    QString type;
+
+    QString locale;
+    QString localeLegacy;
+    QString layoutDirection;
+    QString apiVersion;
+    QString smallestWidth;
+    QString availableWidth;
+    QString availableHeight;
+    QString screenSize;
+    QString screenAspect;
+    QString roundScreen;
+    QString wideColorGamut;
+    QString hdr;
+    QString screenOrientation;
+    QString uiMode;
+    QString nightMode;
+    QString dpi;
+    QString touchscreenType;
+    QString keyboardAvailability;
+    QString inputMethod;
+    QString navigationAvailability;
+    QString navigationMethod;
+
+    // Precomputed keys (see ResourceItemsModel::SortRole):
+    int dpiRank;
+    int apiLevel;
+    QString languageName;
+};
+
+#endif // QUALIFIERSET_H
@@ -0,0 +1,91 @@
+#include "apk/resourcearena.h"
+#include "apk/resourcenode.h"
+#include <new>
+
+namespace
+{
+    const std::size_t BlockSize = 64 * 1024;
+    const std::size_t Alignment = alignof(std::max_align_t);
+
+    struct Header
+    {
+        std::size_t size;
+        bool alive;
+    };
+
+    constexpr std::size_t align(std::size_t size)
+    {
+        return (size + Alignment - 1) / Alignment * Alignment;
+    }
+
+    const std::size_t HeaderSize = align(sizeof(Header));
+
+    inline Header *header(void *pointer)
+    {
+        return reinterpret_cast<Header *>(static_cast<char *>(pointer) - HeaderSize);
+    }
+}
+
+ResourceArena::~ResourceArena()
+{
+    clear();
+}
+
+void *ResourceArena::allocate(std::size_t size)
+{
+    const std::size_t slotSize = HeaderSize + align(size);
+
+    // Resource directories are parsed in parallel:
+    QMutexLocker locker(&mutex);
+
+    if (blocks.isEmpty() || blocks.last().used + slotSize > blocks.last().size) {
+        const std::size_t blockSize = qMax(BlockSize, slotSize);
+        blocks.append({static_cast<char *>(::operator new(blockSize)), blockSize, 0});
+    }
+    Block &block = blocks.last();
+    Header *slot = new (block.data + block.used) Header{slotSize, true};
+    block.used += slotSize;
+    return reinterpret_cast<char *>(slot) + HeaderSize;
+}
+
+void ResourceArena::release(void *pointer)
+{
+    if (pointer) {
+        header(pointer)->alive = false;
+    }
+}
+
+void ResourceArena::clear()
+{
+    const auto nodes = liveNodes();
+
+    // Detach the nodes first, so that they are destroyed in a single pass rather than recursively:
+    for (ResourceNode *node : nodes) {
+        node->children.clear();
+    }
+    for (ResourceNode *node : nodes) {
+        delete node;
+    }
+
+    QMutexLocker locker(&mutex);
+    for (const Block &block : qAsConst(blocks)) {
+        ::operator delete(block.data);
+    }
+    blocks.clear();
+}
+
+QVector<ResourceNode *> ResourceArena::liveNodes() const
+{
+    QVector<ResourceNode *> nodes;
+    for (const Block &block : blocks) {
+        for (std::size_t offset = 0; offset < block.used;) {
+            char *slot = block.data + offset;
+            const Header *slotHeader = reinterpret_cast<const Header *>(slot);
+            if (slotHeader->alive) {
+                nodes.append(reinterpret_cast<ResourceNode *>(slot + HeaderSize));
+            }
+            offset += slotHeader->size;
+        }
+    }
+    return nodes;
+}
@@ -0,0 +1,39 @@
+#ifndef RESOURCEARENA_H
+#define RESOURCEARENA_H
+
+#include <QMutex>
+#include <QVector>
+#include <cstddef>
+
+class ResourceNode;
+
+// Block allocator for the nodes of a single resource tree.
+// Deleting a node runs its destructor but keeps its memory, which is released together with the arena.
+
+class ResourceArena
+{
+public:
+    ResourceArena() = default;
+    ~ResourceArena();
+
+    void *allocate(std::size_t size);
+    static void release(void *pointer);
+    void clear();
+
+private:
+    Q_DISABLE_COPY(ResourceArena)
+
+    struct Block
+    {
+        char *data;
+        std::size_t size;
+        std::size_t used;
+    };
+
+    QVector<ResourceNode *> liveNodes() const;
+
+    QVector<Block> blocks;
+    QMutex mutex;
+};
+
+#endif // RESOURCEARENA_H
@@ -4,27 +4,6 @@
 #include <QFileIconProvider>
 #include <QFileInfo>
 #include <QLocale>
-#include <QRegularExpression>
-
-namespace Qualifiers
-{
-    // Read more: https://developer.android.com/guide/topics/resources/providing-resources.html?hl=en
-    const QStringList layoutDirection = {"ldrtl", "ldltr"};
-    const QStringList screenSize = {"small", "normal", "large", "xlarge"};
-    const QStringList screenAspect = {"long", "notlong"};
-    const QStringList roundScreen = {"round", "notround"};
-    const QStringList wideColorGamut = {"widecg", "nowidecg"};
-    const QStringList hdr = {"highdr", "lowdr"};
-    const QStringList screenOrientation = {"port", "land"};
-    const QStringList uiMode = {"car", "desk", "television", "appliance", "watch", "vrheadset"};
-    const QStringList nightMode = {"night", "notnight"};
-    const QStringList dpi = {"ldpi", "mdpi", "hdpi", "xhdpi", "xxhdpi", "xxxhdpi", "nodpi", "tvdpi", "anydpi"};
-    const QStringList touchscreenType = {"notouch", "finger"};
-    const QStringList keyboardAvailability = {"keysexposed", "keyshidden", "keyssoft"};
-    const QStringList inputMethod = {"nokeys", "qwerty", "12key"};
-    const QStringList navigationAvailability = {"navexposed", "navhidden"};
-    const QStringList navigationMethod = {"nonav", "dpad", "trackball", "wheel"};
-}
 
 ResourceFile::ResourceFile(const QString &path)
 {
@@ -33,80 +12,29 @@ ResourceFile::ResourceFile(const QString &path)
     }
 
     this->path = QDir::fromNativeSeparators(path);
-    const QStringList directoryParts = path.split('/');
-    if (Q_UNLIKELY(directoryParts.size() < 2)) {
+    const int fileSeparator = this->path.lastIndexOf('/');
+    if (Q_UNLIKELY(fileSeparator == -1)) {
         qFatal("CRITICAL: Invalid path passed to resource file constructor");
     }
-    qualifiers = directoryParts.at(directoryParts.size() - 2);
-    QStringList qualifiersParts = qualifiers.split('-');
-    this->type = qualifiersParts.takeFirst();
-    // Replace "-r" region code prefix with "_":
-    qualifiersParts = qualifiersParts.join('-').replace(QRegularExpression("(-r)(?=[A-Za-z]{2}(?=\\z|-))"), "_").split('-');
-    this->readableQualifiers = qualifiersParts.join(" - ");
-
-    for (const QString &qualifier : qAsConst(qualifiersParts)) {
-        if (Qualifiers::layoutDirection.contains(qualifier)) {
-            layoutDirection = qualifier;
-        } else if (qualifier.contains(QRegularExpression("sw\\d+dp"))) {
-            smallestWidth = qualifier;
-        } else if (qualifier.contains(QRegularExpression("w\\d+dp"))) {
-            availableWidth = qualifier;
-        } else if (qualifier.contains(QRegularExpression("h\\d+dp"))) {
-            availableHeight = qualifier;
-        } else if (Qualifiers::screenSize.contains(qualifier)) {
-            screenSize = qualifier;
-        } else if (Qualifiers::screenAspect.contains(qualifier)) {
-            screenAspect = qualifier;
-        } else if (Qualifiers::roundScreen.contains(qualifier)) {
-            roundScreen = qualifier;
-        } else if (Qualifiers::wideColorGamut.contains(qualifier)) {
-            wideColorGamut = qualifier;
-        } else if (Qualifiers::hdr.contains(qualifier)) {
-            hdr = qualifier;
-        } else if (Qualifiers::screenOrientation.contains(qualifier)) {
-            screenOrientation = qualifier;
-        } else if (Qualifiers::uiMode.contains(qualifier)) {
-            uiMode = qualifier;
-        } else if (Qualifiers::nightMode.contains(qualifier)) {
-            nightMode = qualifier;
-        } else if (Qualifiers::dpi.contains(qualifier)) {
-            dpi = qualifier;
-        } else if (Qualifiers::touchscreenType.contains(qualifier)) {
-            touchscreenType = qualifier;
-        } else if (Qualifiers::keyboardAvailability.contains(qualifier)) {
-            keyboardAvailability = qualifier;
-        } else if (Qualifiers::inputMethod.contains(qualifier)) {
-            inputMethod = qualifier;
-        } else if (Qualifiers::navigationAvailability.contains(qualifier)) {
-            navigationAvailability = qualifier;
-        } else if (Qualifiers::navigationMethod.contains(qualifier)) {
-            navigationMethod = qualifier;
-        } else if (qualifier.contains(QRegularExpression("v\\d+"))) {
-            apiVersion = qualifier;
-        } else {
-            locale = qualifier;
-            // Handle legacy locales:
-            if (locale == "iw") {
-                localeLegacy = "he";
-            } else if (locale == "ji") {
-                localeLegacy = "yi";
-            } else if (locale == "in") {
-                localeLegacy = "id";
-            } else {
-                localeLegacy = locale;
-            }
-        }
-    }
+    const int directorySeparator = fileSeparator > 0 ? this->path.lastIndexOf('/', fileSeparator - 1) : -1;
+    qualifierSet = QualifierSet::intern(this->path.mid(directorySeparator + 1, fileSeparator - directorySeparator - 1));
+}
+
+ResourceFile::ResourceFile(const QString &path, const QSharedPointer<const QualifierSet> &qualifierSet)
+    : path(QDir::fromNativeSeparators(path))
+    , qualifierSet(qualifierSet)
+{
+    Q_ASSERT(qualifierSet);
 }
 
 QString ResourceFile::getQualifiers() const
 {
-    return qualifiers;
+    return qualifierSet->qualifiers;
 }
 
 QString ResourceFile::getReadableQualifiers() const
 {
-    return readableQualifiers;
+    return qualifierSet->readableQualifiers;
 }
 
 QString ResourceFile::getName() const
@@ -116,33 +44,42 @@ QString ResourceFile::getName() const
 
 QString ResourceFile::getType() const
 {
-    return type;
+    return qualifierSet->type;
 }
 
 QString ResourceFile::getDpi() const
 {
-    return dpi.toUpper();
+    return qualifierSet->dpi.toUpper();
+}
+
+int ResourceFile::getDpiRank() const
+{
+    return qualifierSet->dpiRank;
 }
 
 QString ResourceFile::getApiVersion() const
 {
-    return apiVersion;
+    return qualifierSet->apiVersion;
+}
+
+int ResourceFile::getApiLevel() const
+{
+    return qualifierSet->apiLevel;
 }
 
 QString ResourceFile::getLocaleCode() const
 {
-    return locale;
+    return qualifierSet->locale;
 }
 
 QString ResourceFile::getLanguageName() const
 {
-    QString native = QLocale(localeLegacy).nativeLanguageName();
-    return Utils::capitalize(native);
+    return qualifierSet->languageName;
 }
 
 QIcon ResourceFile::getLanguageIcon() const
 {
-    return Utils::getLocaleFlag(QLocale(localeLegacy));
+    return Utils::getLocaleFlag(QLocale(qualifierSet->localeLegacy));
 }
 
 QString ResourceFile::getFileName() const
@@ -162,10 +99,5 @@ QString ResourceFile::getDirectory() const
 
 QIcon ResourceFile::getFileIcon(const QFileIconProvider &iconProvider) const
 {
-    const QString filePath = getFilePath();
-    if (Utils::isImageReadable(filePath)) {
-        QPixmap thumbnail(filePath);
-        return thumbnail;
-    }
-    return iconProvider.icon(filePath);
+    return iconProvider.icon(getFilePath());
 }
@@ -1,6 +1,7 @@
 #ifndef RESOURCEFILE_H
 #define RESOURCEFILE_H
 
+#include "apk/qualifierset.h"
 #include <QIcon>
 
 class QFileIconProvider;
@@ -9,16 +10,19 @@ class ResourceFile
 {
 public:
     ResourceFile(const QString &path);
+    ResourceFile(const QString &path, const QSharedPointer<const QualifierSet> &qualifierSet);
 
     QString getQualifiers() const;
     QString getReadableQualifiers() const;
     QString getName() const;
     QString getType() const; // E.g., "drawable", "values", etc.
     QString getDpi() const;
+    int getDpiRank() const;
     QString getLocaleCode() const;
     QString getLanguageName() const;
     QIcon getLanguageIcon() const;
     QString getApiVersion() const;
+    int getApiLevel() const;
     QString getFileName() const;
     QString getFilePath() const;
     QString getDirectory() const;
@@ -26,32 +30,7 @@ public:
 
 private:
     QString path;
-    QString type;
-    QString qualifiers;
-    QString readableQualifiers;
-
-    // Qualifiers:
-    QString locale;
-    QString localeLegacy;
-    QString layoutDirection;
-    QString apiVersion;
-    QString smallestWidth;
-    QString availableWidth;
-    QString availableHeight;
-    QString screenSize;
-    QString screenAspect;
-    QString roundScreen;
-    QString wideColorGamut;
-    QString hdr;
-    QString screenOrientation;
-    QString uiMode;
-    QString nightMode;
-    QString dpi;
-    QString touchscreenType;
-    QString keyboardAvailability;
-    QString inputMethod;
-    QString navigationAvailability;
-    QString navigationMethod;
+    QSharedPointer<const QualifierSet> qualifierSet;
 };
 
 #endif // RESOURCEFILE_H
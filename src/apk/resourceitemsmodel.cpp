@@ -4,7 +4,14 @@
 #include "base/utils.h"
 #include <QtConcurrent/QtConcurrent>
 #include <QDirIterator>
+#include <QFutureWatcher>
 #include <QIcon>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QMessageBox>
+#include <QPointer>
+#include <QSaveFile>
+#include <QTimer>
 
 #ifdef QT_DEBUG
     #include <QDebug>
@@ -12,81 +19,235 @@
 
 ResourceItemsModel::ResourceItemsModel(QObject *parent)
     : QAbstractItemModel(parent)
-    , root(new ResourceNode)
-{}
+    , root(new (arena) ResourceNode)
+    , thumbnails(Utils::scale(48, 48))
+{
+    connect(&thumbnails, &ThumbnailCache::thumbnailReady, this, [this](const QString &path) {
+        const QModelIndex pathIndex = findIndex(path);
+        if (pathIndex.isValid()) {
+            const QModelIndex index = pathIndex.sibling(pathIndex.row(), CaptionColumn);
+            emit dataChanged(index, index, {Qt::DecorationRole});
+        }
+    });
+    connect(&watcher, &ResourceWatcher::directoriesChanged, this, &ResourceItemsModel::synchronize);
+}
 
 ResourceItemsModel::~ResourceItemsModel()
 {
-    delete root;
+    initialization.waitForFinished();
 }
 
 QFuture<void> ResourceItemsModel::initialize(const QString &path)
 {
-    beginResetModel();
-
-    return QtConcurrent::run([=] {
-
-        // Parse resource directories:
-
-        QMap<QString, ResourceNode *> mapResourceTypes;
-        QMap<QString, ResourceNode *> mapResourceGroups;
-
-        QDirIterator resourceDirectories(path, QDir::Dirs | QDir::NoDotAndDotDot);
-        while (resourceDirectories.hasNext()) {
+    // The previous tree has to be parsed completely before it is released:
+    initialization.waitForFinished();
 
-            const QFileInfo resourceDirectory = QFileInfo(resourceDirectories.next());
-            const QString resourceTypeTitle = resourceDirectory.fileName().split('-').first(); // E.g., "drawable", "values"...
-            ResourceNode *resourceTypeNode = mapResourceTypes.value(resourceTypeTitle, nullptr);
-            if (!resourceTypeNode) {
-                resourceTypeNode = new ResourceNode(resourceTypeTitle, nullptr);
-                root->addChild(resourceTypeNode);
-                mapResourceTypes[resourceTypeTitle] = resourceTypeNode;
-            }
+    beginResetModel();
+    thumbnails.clear();
+    nodesByPath.clear();
+    nodesByCaptionPath.clear();
+    pendingTypes.clear();
+    ++generation;
+
+    // Release the previous tree at once:
+    arena.clear();
+    root = new (arena) ResourceNode;
+
+    // Create the resource type nodes right away, their contents are populated later:
+
+    QHash<QString, ResourceNode *> mapResourceTypes;
+    QHash<ResourceNode *, QVector<ResourceDirectory>> mapTypeDirectories;
+    QDirIterator resourceDirectories(path, QDir::Dirs | QDir::NoDotAndDotDot);
+    while (resourceDirectories.hasNext()) {
+        ResourceDirectory directory;
+        directory.path = resourceDirectories.next();
+        const QString resourceType = QualifierSet::intern(resourceDirectories.fileName())->type;
+        ResourceNode *resourceTypeNode = mapResourceTypes.value(resourceType, nullptr);
+        if (!resourceTypeNode) {
+            resourceTypeNode = new (arena) ResourceNode(resourceType, nullptr);
+            root->addChild(resourceTypeNode);
+            registerNode(resourceTypeNode);
+            mapResourceTypes[resourceType] = resourceTypeNode;
+        }
+        mapTypeDirectories[resourceTypeNode].append(directory);
+    }
 
-            // Parse resource files:
+    endResetModel();
+
+    // Pick up the files added or removed outside of the model:
+    watcher.watch(path);
+
+    // Parse resource types in the background, each one with its directories in parallel.
+    // A resource type which is expanded before its turn is parsed immediately (see fetchMore()).
+
+    QList<QFuture<QVector<ResourceDirectory>>> parsings;
+    const int currentGeneration = generation;
+    for (auto it = mapTypeDirectories.constBegin(); it != mapTypeDirectories.constEnd(); ++it) {
+        ResourceNode *resourceTypeNode = it.key();
+        QVector<ResourceDirectory> directories = it.value();
+        auto parsing = QtConcurrent::run([=]() mutable {
+            QtConcurrent::blockingMap(directories, [this](ResourceDirectory &directory) {
+                parseDirectory(directory, arena);
+            });
+            QMetaObject::invokeMethod(this, [=]() {
+                if (generation == currentGeneration) {
+                    populate(resourceTypeNode);
+                }
+            }, Qt::QueuedConnection);
+            return directories;
+        });
+        pendingTypes.insert(resourceTypeNode, parsing);
+        parsings.append(parsing);
+    }
 
-            QDirIterator resourceFiles(resourceDirectory.filePath(), QDir::Files);
-            while (resourceFiles.hasNext()) {
+    initialization = QtConcurrent::run([parsings]() {
+        for (auto parsing : parsings) {
+            parsing.waitForFinished();
+        }
+    });
+    return initialization;
+}
 
-                const QFileInfo resourceFile(resourceFiles.next());
-                const QString resourceFilename = resourceFile.fileName();
+void ResourceItemsModel::parseDirectory(ResourceDirectory &directory, ResourceArena &arena)
+{
+    // All the files of the directory share the same qualifiers:
+    const auto qualifierSet = QualifierSet::intern(QFileInfo(directory.path).fileName());
 
-                ResourceNode *resourceGroupNode  = mapResourceGroups.value(resourceFilename, nullptr);
-                if (!resourceGroupNode) {
-                    resourceGroupNode = new ResourceNode(resourceFilename, nullptr);
-                    resourceTypeNode->addChild(resourceGroupNode);
-                    mapResourceGroups[resourceFilename] = resourceGroupNode;
-                }
+    QDirIterator resourceFiles(directory.path, QDir::Files);
+    while (resourceFiles.hasNext()) {
+        const QString resourceFilePath = resourceFiles.next();
+        directory.files.append(new (arena) ResourceNode(resourceFiles.fileName(), new ResourceFile(resourceFilePath, qualifierSet)));
+    }
+}
 
-                ResourceNode *fileNode = new ResourceNode(resourceFilename, new ResourceFile(resourceFile.filePath()));
-                resourceGroupNode->addChild(fileNode);
+void ResourceItemsModel::populate(ResourceNode *typeNode)
+{
+    auto it = pendingTypes.find(typeNode);
+    if (it == pendingTypes.end()) {
+        return; // Already populated
+    }
+    const QVector<ResourceDirectory> parsedDirectories = it.value().result();
+    pendingTypes.erase(it);
+
+    // Group the parsed files by their names (e.g., "drawable-hdpi/icon.png" and "drawable-xhdpi/icon.png"):
+
+    QVector<ResourceNode *> resourceGroupNodes;
+    QHash<QString, ResourceNode *> mapResourceGroups;
+    for (const ResourceDirectory &directory : parsedDirectories) {
+        for (ResourceNode *fileNode : directory.files) {
+            const QString resourceFilename = fileNode->getCaption();
+            ResourceNode *resourceGroupNode = mapResourceGroups.value(resourceFilename, nullptr);
+            if (!resourceGroupNode) {
+                resourceGroupNode = new (arena) ResourceNode(resourceFilename, nullptr);
+                resourceGroupNodes.append(resourceGroupNode);
+                mapResourceGroups[resourceFilename] = resourceGroupNode;
             }
+            resourceGroupNode->addChild(fileNode);
         }
+    }
+    if (resourceGroupNodes.isEmpty()) {
+        return;
+    }
 
-        endResetModel();
-    });
+    const int first = typeNode->childCount();
+    beginInsertRows(nodeIndex(typeNode), first, first + resourceGroupNodes.count() - 1);
+    for (ResourceNode *resourceGroupNode : qAsConst(resourceGroupNodes)) {
+        typeNode->addChild(resourceGroupNode);
+        registerNode(resourceGroupNode);
+    }
+    endInsertRows();
 }
 
-QModelIndex ResourceItemsModel::addNode(ResourceNode *node, const QModelIndex &parent)
+QModelIndex ResourceItemsModel::addNode(const QString &caption, ResourceFile *file, const QModelIndex &parent)
 {
     ResourceNode *parentNode = parent.isValid() ? static_cast<ResourceNode *>(parent.internalPointer()) : root;
-    beginInsertRows(parent, rowCount(parent), rowCount(parent));
-        parentNode->addChild(node);
-    endInsertRows();
-    auto index = createIndex(rowCount(parent) - 1, 0, node);
-    return index;
+    auto node = insertNode(parentNode, new (arena) ResourceNode(caption, file));
+    return createIndex(node->row(), 0, node);
 }
 
 bool ResourceItemsModel::replaceResource(const QModelIndex &index, const QString &with, QWidget *parent)
 {
     const QString what = ResourceModelIndex(index).path();
     if (Utils::replaceFile(what, with, parent)) {
+        thumbnails.invalidate(what);
         emit dataChanged(index, index);
         return true;
     }
     return false;
 }
 
+bool ResourceItemsModel::replaceImages(const QModelIndexList &indexes, const QString &with, QWidget *parent)
+{
+    struct ImageReplacement
+    {
+        QPersistentModelIndex index;
+        QString path;
+        bool success;
+    };
+
+    QSharedPointer<QVector<ImageReplacement>> replacements(new QVector<ImageReplacement>);
+    for (const QModelIndex &index : indexes) {
+        const QString path = getResourcePath(index);
+        if (!path.isEmpty() && Utils::isImageWritable(path) && QFileInfo(path) != QFileInfo(with)) {
+            replacements->append({index.sibling(index.row(), 0), path, false});
+        }
+    }
+    if (replacements->isEmpty()) {
+        return false;
+    }
+
+    // Decode the new image once:
+    const QImage image(with);
+    if (image.isNull()) {
+        QMessageBox::warning(parent, QString(), tr("Could not read the image."));
+        return false;
+    }
+
+    // Resample the image to the dimensions of each replaced image (e.g., 48x48 for mdpi, 192x192 for xxxhdpi).
+    // The image is scaled to cover the target and cropped to its center, so the result has the exact target size:
+    auto future = QtConcurrent::map(*replacements, [image, replacements](ImageReplacement &replacement) {
+        Q_UNUSED(replacements) // Keeps the sequence alive until the workers are done, even if the model is gone
+        const QSize size = QImageReader(replacement.path).size();
+        QImage resampled = image;
+        if (size.isValid() && size != image.size()) {
+            resampled = image.scaled(size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+            resampled = resampled.copy((resampled.width() - size.width()) / 2,
+                                       (resampled.height() - size.height()) / 2,
+                                       size.width(), size.height());
+        }
+        QSaveFile file(replacement.path);
+        QImageWriter writer(&file, QFileInfo(replacement.path).suffix().toLower().toLatin1());
+        replacement.success = file.open(QIODevice::WriteOnly) && writer.write(resampled) && file.commit();
+    });
+
+    QPointer<QWidget> parentWidget(parent);
+    auto watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [=]() {
+        watcher->deleteLater();
+
+        // Notify about every replaced row on its own: the files of a group live in different
+        // directories, so a range of group rows wouldn't map to a range in the file system model:
+        bool success = true;
+        for (const ImageReplacement &replacement : qAsConst(*replacements)) {
+            if (!replacement.success) {
+                success = false;
+                continue;
+            }
+            thumbnails.invalidate(replacement.path);
+            if (replacement.index.isValid()) {
+                const QModelIndex index = replacement.index;
+                emit dataChanged(index, index.sibling(index.row(), ColumnCount - 1));
+            }
+        }
+
+        if (!success) {
+            QMessageBox::warning(parentWidget, QString(), tr("Could not replace the file."));
+        }
+    });
+    watcher->setFuture(future);
+    return true;
+}
+
 bool ResourceItemsModel::removeResource(const QModelIndex &index)
 {
     if (!index.isValid()) {
@@ -117,21 +278,10 @@ QVariant ResourceItemsModel::data(const QModelIndex &index, int role) const
             switch (role) {
             case SortRole:
                 switch (column) {
-                case DpiColumn: {
-                    auto dpi = file->getDpi().toLower();
-                    if (dpi == "ldpi") { return 0; }
-                    if (dpi == "mdpi") { return 1; }
-                    if (dpi == "hdpi") { return 2; }
-                    if (dpi == "xhdpi") { return 3; }
-                    if (dpi == "xxhdpi") { return 4; }
-                    if (dpi == "xxxhdpi") { return 5; }
-                    if (dpi == "nodpi") { return 6; }
-                    if (dpi == "tvdpi") { return 7; }
-                    if (dpi == "anydpi") { return 8; }
-                    return 9;
-                }
+                case DpiColumn:
+                    return file->getDpiRank();
                 case ApiColumn:
-                    return file->getApiVersion().remove(0, 1).toInt();
+                    return file->getApiLevel();
                 }
             case Qt::DisplayRole:
                 switch (column) {
@@ -151,8 +301,15 @@ QVariant ResourceItemsModel::data(const QModelIndex &index, int role) const
                 break;
             case Qt::DecorationRole:
                 switch (column) {
-                case CaptionColumn:
+                case CaptionColumn: {
+                    const QString filePath = file->getFilePath();
+                    if (Utils::isImageReadable(filePath)) {
+                        // Images are decoded in the background, a generic file icon is displayed meanwhile:
+                        const QPixmap thumbnail = thumbnails.thumbnail(filePath);
+                        return !thumbnail.isNull() ? QIcon(thumbnail) : iconProvider.icon(QFileIconProvider::File);
+                    }
                     return file->getFileIcon(iconProvider);
+                }
                 case LanguageColumn:
                     return file->getLanguageIcon();
                 }
@@ -223,6 +380,26 @@ int ResourceItemsModel::columnCount(const QModelIndex &parent) const
     return ColumnCount;
 }
 
+bool ResourceItemsModel::hasChildren(const QModelIndex &parent) const
+{
+    if (canFetchMore(parent)) {
+        return true;
+    }
+    return QAbstractItemModel::hasChildren(parent);
+}
+
+bool ResourceItemsModel::canFetchMore(const QModelIndex &parent) const
+{
+    return parent.isValid() && pendingTypes.contains(static_cast<ResourceNode *>(parent.internalPointer()));
+}
+
+void ResourceItemsModel::fetchMore(const QModelIndex &parent)
+{
+    if (canFetchMore(parent)) {
+        populate(static_cast<ResourceNode *>(parent.internalPointer()));
+    }
+}
+
 bool ResourceItemsModel::removeRows(int row, int count, const QModelIndex &parent)
 {
     auto parentNode = parent.isValid() ? static_cast<ResourceNode *>(parent.internalPointer()) : root;
@@ -242,6 +419,7 @@ bool ResourceItemsModel::removeRows(int row, int count, const QModelIndex &paren
     // Proceed by removing the corresponsing rows
     beginRemoveRows(parent, row, lastDeleteRow);
     for (int i = row; i <= lastDeleteRow; ++i) {
+        unregisterNode(parentNode->getChild(row));
         parentNode->removeChild(row);
     }
     endRemoveRows();
@@ -252,6 +430,7 @@ bool ResourceItemsModel::removeRows(int row, int count, const QModelIndex &paren
         if (grandparent.isValid()) {
             beginRemoveRows(grandparent, parent.row(), parent.row());
                 auto grandparentNode = static_cast<ResourceNode *>(grandparent.internalPointer());
+                unregisterNode(parentNode);
                 grandparentNode->removeChild(parent.row());
             endRemoveRows();
         }
@@ -262,22 +441,11 @@ bool ResourceItemsModel::removeRows(int row, int count, const QModelIndex &paren
 
 QModelIndex ResourceItemsModel::findIndex(const QString &path) const
 {
-    return findIndex(path, {});
-}
-
-QModelIndex ResourceItemsModel::findIndex(const QString &path, const QModelIndex &parent) const
-{
-    for (int row = 0; row < rowCount(parent); ++row) {
-        auto resource = index(row, PathColumn, parent);
-        if (resource.data().toString() == path) {
-            return resource;
-        }
-        resource = findIndex(path, resource);
-        if (resource.isValid()) {
-            return resource;
-        }
+    ResourceNode *node = nodesByPath.value(QDir::fromNativeSeparators(path), nullptr);
+    if (!node) {
+        return {};
     }
-    return {};
+    return createIndex(node->row(), PathColumn, node);
 }
 
 const ResourceFile *ResourceItemsModel::getResourceFile(const QModelIndex &index) const
@@ -289,3 +457,177 @@ const ResourceFile *ResourceItemsModel::getResourceFile(const QModelIndex &index
     ResourceFile *resource = node->getFile();
     return resource;
 }
+
+void ResourceItemsModel::updateThumbnail(const QString &path)
+{
+    // The file has been written outside of the model (e.g., saved from an editor tab):
+    thumbnails.invalidate(path);
+    const QModelIndex pathIndex = findIndex(path);
+    if (pathIndex.isValid()) {
+        const QModelIndex index = pathIndex.sibling(pathIndex.row(), CaptionColumn);
+        emit dataChanged(index, index, {Qt::DecorationRole});
+    }
+}
+
+bool ResourceItemsModel::isThumbnailUpdate(const QVector<int> &roles)
+{
+    return roles.count() == 1 && roles.contains(Qt::DecorationRole);
+}
+
+void ResourceItemsModel::registerNode(ResourceNode *node)
+{
+    const ResourceFile *file = node->getFile();
+    if (file) {
+        nodesByPath.insert(file->getFilePath(), node);
+    } else {
+        const QString path = captionPath(node);
+        if (!path.isEmpty()) {
+            nodesByCaptionPath.insert(path, node);
+        }
+    }
+    for (int row = 0; row < node->childCount(); ++row) {
+        registerNode(node->getChild(row));
+    }
+}
+
+void ResourceItemsModel::unregisterNode(ResourceNode *node)
+{
+    const ResourceFile *file = node->getFile();
+    if (file) {
+        thumbnails.invalidate(file->getFilePath());
+        auto it = nodesByPath.find(file->getFilePath());
+        if (it != nodesByPath.end() && it.value() == node) {
+            nodesByPath.erase(it);
+        }
+    } else {
+        auto it = nodesByCaptionPath.find(captionPath(node));
+        if (it != nodesByCaptionPath.end() && it.value() == node) {
+            nodesByCaptionPath.erase(it);
+        }
+    }
+    for (int row = 0; row < node->childCount(); ++row) {
+        unregisterNode(node->getChild(row));
+    }
+}
+
+void ResourceItemsModel::synchronize(const QStringList &directories)
+{
+    if (!pendingTypes.isEmpty()) {
+        // Apply the changes once the tree is complete:
+        QTimer::singleShot(100, this, [=]() {
+            synchronize(directories);
+        });
+        return;
+    }
+
+    const QString resourcesPath = watcher.path();
+
+    // Group the known files by their directories:
+    QHash<QString, QSet<QString>> knownFiles;
+    for (auto it = nodesByPath.constBegin(); it != nodesByPath.constEnd(); ++it) {
+        knownFiles[it.key().left(it.key().lastIndexOf('/'))].insert(it.key());
+    }
+
+    QSet<QString> changedDirectories;
+    for (const QString &directory : directories) {
+        if (directory == resourcesPath) {
+            // Resource directories might have been added or removed:
+            for (auto it = knownFiles.constBegin(); it != knownFiles.constEnd(); ++it) {
+                changedDirectories.insert(it.key());
+            }
+            QDirIterator resourceDirectories(resourcesPath, QDir::Dirs | QDir::NoDotAndDotDot);
+            while (resourceDirectories.hasNext()) {
+                changedDirectories.insert(resourceDirectories.next());
+            }
+        } else if (!resourcesPath.isEmpty() && directory.startsWith(resourcesPath)) {
+            changedDirectories.insert(directory);
+        }
+    }
+
+    // Apply the difference between the tree and the file system:
+    for (const QString &directory : qAsConst(changedDirectories)) {
+        const QSet<QString> oldFiles = knownFiles.value(directory);
+        QSet<QString> newFiles;
+        QDirIterator resourceFiles(directory, QDir::Files);
+        while (resourceFiles.hasNext()) {
+            newFiles.insert(QDir::fromNativeSeparators(resourceFiles.next()));
+        }
+        for (const QString &path : oldFiles) {
+            ResourceNode *node = nodesByPath.value(path, nullptr);
+            if (node && !newFiles.contains(path)) {
+                removeNode(node);
+            }
+        }
+        QStringList addedFiles;
+        for (const QString &path : qAsConst(newFiles)) {
+            if (!oldFiles.contains(path)) {
+                addedFiles.append(path);
+            }
+        }
+        addedFiles.sort();
+        for (const QString &path : qAsConst(addedFiles)) {
+            insertFile(path);
+        }
+    }
+}
+
+void ResourceItemsModel::insertFile(const QString &path)
+{
+    const int fileSeparator = path.lastIndexOf('/');
+    const QString directory = path.left(fileSeparator);
+    const QString filename = path.mid(fileSeparator + 1);
+    const auto qualifierSet = QualifierSet::intern(directory.mid(directory.lastIndexOf('/') + 1));
+
+    ResourceNode *typeNode = nodesByCaptionPath.value(qualifierSet->type, nullptr);
+    if (!typeNode) {
+        typeNode = insertNode(root, new (arena) ResourceNode(qualifierSet->type));
+    }
+    ResourceNode *groupNode = nodesByCaptionPath.value(qualifierSet->type + '/' + filename, nullptr);
+    if (!groupNode) {
+        groupNode = insertNode(typeNode, new (arena) ResourceNode(filename));
+    }
+    insertNode(groupNode, new (arena) ResourceNode(filename, new ResourceFile(path, qualifierSet)));
+}
+
+ResourceNode *ResourceItemsModel::insertNode(ResourceNode *parentNode, ResourceNode *node)
+{
+    const int row = parentNode->childCount();
+    beginInsertRows(nodeIndex(parentNode), row, row);
+        parentNode->addChild(node);
+        registerNode(node);
+    endInsertRows();
+    return node;
+}
+
+void ResourceItemsModel::removeNode(ResourceNode *node)
+{
+    // Remove the node along with the ancestors it leaves empty:
+    ResourceNode *parentNode = node->getParent();
+    while (parentNode != root && parentNode->childCount() == 1) {
+        node = parentNode;
+        parentNode = node->getParent();
+    }
+    const int row = node->row();
+    beginRemoveRows(nodeIndex(parentNode), row, row);
+        unregisterNode(node);
+        parentNode->removeChild(row);
+    endRemoveRows();
+}
+
+QString ResourceItemsModel::captionPath(const ResourceNode *node) const
+{
+    // Only the type and group nodes are addressed by their captions:
+    const ResourceNode *parentNode = node->getParent();
+    if (parentNode == root) {
+        return node->getCaption();
+    }
+    if (parentNode && parentNode->getParent() == root) {
+        return parentNode->getCaption() + '/' + node->getCaption();
+    }
+    return QString();
+}
+
+QModelIndex ResourceItemsModel::nodeIndex(ResourceNode *node) const
+{
+    return node != root ? createIndex(node->row(), 0, node) : QModelIndex();
+}
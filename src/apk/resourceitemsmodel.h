@@ -2,9 +2,13 @@
 #define RESOURCEITEMSMODEL_H
 
 #include "apk/iresourceitemsmodel.h"
+#include "apk/resourcearena.h"
+#include "apk/resourcewatcher.h"
+#include "base/thumbnailcache.h"
 #include <QAbstractItemModel>
 #include <QFileIconProvider>
 #include <QFuture>
+#include <QHash>
 
 class ResourceFile;
 class ResourceNode;
@@ -34,8 +38,9 @@ public:
     ~ResourceItemsModel() override;
 
     QFuture<void> initialize(const QString &path);
-    QModelIndex addNode(ResourceNode *node, const QModelIndex &parent = QModelIndex());
+    QModelIndex addNode(const QString &caption, ResourceFile *file, const QModelIndex &parent = QModelIndex());
     bool replaceResource(const QModelIndex &index, const QString &file = QString(), QWidget *parent = nullptr) override;
+    bool replaceImages(const QModelIndexList &indexes, const QString &file, QWidget *parent = nullptr);
     bool removeResource(const QModelIndex &index) override;
     QString getResourcePath(const QModelIndex &index) const override;
 
@@ -45,15 +50,47 @@ public:
     QModelIndex parent(const QModelIndex &index) const override;
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
     bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
 
     QModelIndex findIndex(const QString &path) const;
-    QModelIndex findIndex(const QString &path, const QModelIndex &parent) const;
     const ResourceFile *getResourceFile(const QModelIndex &index) const;
+    void updateThumbnail(const QString &path);
+
+    // Decoded thumbnails are announced with a decoration-only change, which doesn't modify the resource:
+    static bool isThumbnailUpdate(const QVector<int> &roles);
 
 private:
+    struct ResourceDirectory
+    {
+        QString path;
+        QVector<ResourceNode *> files;
+    };
+
+    static void parseDirectory(ResourceDirectory &directory, ResourceArena &arena);
+    void populate(ResourceNode *typeNode);
+    void registerNode(ResourceNode *node);
+    void unregisterNode(ResourceNode *node);
+
+    void synchronize(const QStringList &directories);
+    void insertFile(const QString &path);
+    ResourceNode *insertNode(ResourceNode *parentNode, ResourceNode *node);
+    void removeNode(ResourceNode *node);
+    QString captionPath(const ResourceNode *node) const;
+    QModelIndex nodeIndex(ResourceNode *node) const;
+
+    ResourceArena arena;
     ResourceNode *root;
+    QHash<QString, ResourceNode *> nodesByPath;
+    QHash<QString, ResourceNode *> nodesByCaptionPath; // Type and group nodes (e.g., "drawable/icon.png")
     QFileIconProvider iconProvider;
+    mutable ThumbnailCache thumbnails;
+    ResourceWatcher watcher;
+    QFuture<void> initialization;
+    QHash<ResourceNode *, QFuture<QVector<ResourceDirectory>>> pendingTypes;
+    int generation = 0;
 };
 
 #endif // RESOURCEITEMSMODEL_H
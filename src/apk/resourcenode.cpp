@@ -1,4 +1,5 @@
 #include "apk/resourcenode.h"
+#include "apk/resourcearena.h"
 #include <QFile>
 
 ResourceNode::ResourceNode(const QString &caption, ResourceFile *file)
@@ -50,3 +51,19 @@ ResourceNode *ResourceNode::getParent() const
 {
     return static_cast<ResourceNode *>(parent);
 }
+
+void *ResourceNode::operator new(std::size_t size, ResourceArena &arena)
+{
+    return arena.allocate(size);
+}
+
+void ResourceNode::operator delete(void *pointer, ResourceArena &arena)
+{
+    Q_UNUSED(arena)
+    ResourceArena::release(pointer);
+}
+
+void ResourceNode::operator delete(void *pointer)
+{
+    ResourceArena::release(pointer);
+}
@@ -3,6 +3,9 @@
 
 #include "base/treenode.h"
 #include "apk/resourcefile.h"
+#include <cstddef>
+
+class ResourceArena;
 
 class ResourceNode : public TreeNode
 {
@@ -20,7 +23,14 @@ public:
     ResourceNode *getChild(int row) const;
     ResourceNode *getParent() const;
 
+    // Nodes are allocated in the arena of their tree (e.g., "new (arena) ResourceNode"):
+    static void *operator new(std::size_t size, ResourceArena &arena);
+    static void operator delete(void *pointer, ResourceArena &arena);
+    static void operator delete(void *pointer);
+
 private:
+    friend class ResourceArena;
+
     QString caption;
     ResourceFile *file;
 };
@@ -0,0 +1,62 @@
+#include "apk/resourcewatcher.h"
+#include <QDirIterator>
+
+ResourceWatcher::ResourceWatcher(QObject *parent) : QObject(parent)
+{
+    timer.setSingleShot(true);
+    timer.setInterval(300);
+
+    connect(&watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString &directory) {
+        if (directory == resourcesPath) {
+            // Resource directories might have been added:
+            watchDirectories();
+        }
+        changedDirectories.insert(directory);
+        timer.start();
+    });
+
+    connect(&timer, &QTimer::timeout, this, [this]() {
+        const QStringList directories = changedDirectories.values();
+        changedDirectories.clear();
+        emit directoriesChanged(directories);
+    });
+}
+
+void ResourceWatcher::watch(const QString &path)
+{
+    stop();
+    resourcesPath = path;
+    watchDirectories();
+}
+
+void ResourceWatcher::stop()
+{
+    timer.stop();
+    changedDirectories.clear();
+    const QStringList directories = watcher.directories();
+    if (!directories.isEmpty()) {
+        watcher.removePaths(directories);
+    }
+    resourcesPath.clear();
+}
+
+QString ResourceWatcher::path() const
+{
+    return resourcesPath;
+}
+
+void ResourceWatcher::watchDirectories()
+{
+    QStringList directories(resourcesPath);
+    QDirIterator resourceDirectories(resourcesPath, QDir::Dirs | QDir::NoDotAndDotDot);
+    while (resourceDirectories.hasNext()) {
+        directories.append(resourceDirectories.next());
+    }
+    const QStringList watchedDirectories = watcher.directories();
+    for (const QString &directory : watchedDirectories) {
+        directories.removeOne(directory);
+    }
+    if (!directories.isEmpty()) {
+        watcher.addPaths(directories);
+    }
+}
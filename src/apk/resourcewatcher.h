@@ -0,0 +1,34 @@
+#ifndef RESOURCEWATCHER_H
+#define RESOURCEWATCHER_H
+
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QTimer>
+
+// Watches the "res" directory and its resource directories for added and removed files.
+// Changes are collected and reported in batches once the directories have stayed unchanged for a moment.
+
+class ResourceWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ResourceWatcher(QObject *parent = nullptr);
+
+    void watch(const QString &path);
+    void stop();
+    QString path() const;
+
+signals:
+    void directoriesChanged(const QStringList &directories);
+
+private:
+    void watchDirectories();
+
+    QString resourcesPath;
+    QFileSystemWatcher watcher;
+    QTimer timer;
+    QSet<QString> changedDirectories;
+};
+
+#endif // RESOURCEWATCHER_H
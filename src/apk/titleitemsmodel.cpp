@@ -1,7 +1,6 @@
 #include "apk/titleitemsmodel.h"
 #include <QFile>
 #include <QDirIterator>
-#include <QTextStream>
 #include <QDebug>
 #include <QtConcurrent/QtConcurrent>
 
@@ -10,53 +9,42 @@ TitleItemsModel::TitleItemsModel(const Package *apk, QObject *parent) : QAbstrac
     // Parse application label attribute (android:label):
 
     auto finishedFuture = QtConcurrent::run([=]() -> QList<TitleNode *> {
-        QList<TitleNode *> result;
         QString labelAttribute = apk->manifest->applicationScope->label().getValue();
         if (!labelAttribute.startsWith("@string/")) {
             return {};
         }
-        QString labelKey = labelAttribute.mid(QString("@string/").length());
-
-        // Parse resource directories:
-
-        QDirIterator resourceDirectories(apk->getContentsPath() + "/res/", QDir::Dirs | QDir::NoDotAndDotDot);
-        while (resourceDirectories.hasNext()) {
-
-            const QString resourceDirectory = QFileInfo(resourceDirectories.next()).fileName();
-            const QString resourceType = resourceDirectory.split('-').first();
-
-            if (resourceType == "values") {
+        const QString labelKey = labelAttribute.mid(QString("@string/").length());
 
-                // Parse resource files:
+        // Collect string resource files:
 
-                QDirIterator resourceFiles(apk->getContentsPath() + "/res/" + resourceDirectory, QDir::Files);
-                while (resourceFiles.hasNext()) {
-                    const QString resourceFile = QFileInfo(resourceFiles.next()).filePath();
-                    QFile xml(resourceFile);
-                    if (xml.open(QFile::ReadOnly)) {
-                        QTextStream stream(&xml);
-                        stream.setCodec("UTF-8");
-                        QDomDocument xmlDocument;
-                        xmlDocument.setContent(stream.readAll());
+        struct TitleFile
+        {
+            QString path;
+            TitleNode *title;
+        };
 
-                        // Iterate through XML child elements:
+        QVector<TitleFile> titleFiles;
+        QDirIterator resourceDirectories(apk->getContentsPath() + "/res/", {"values*"}, QDir::Dirs | QDir::NoDotAndDotDot);
+        while (resourceDirectories.hasNext()) {
+            const QString resourceDirectory = resourceDirectories.next();
+            if (resourceDirectories.fileName().split('-').first() == "values") {
+                const QString resourceFile = resourceDirectory + "/strings.xml";
+                if (QFile::exists(resourceFile)) {
+                    titleFiles.append({resourceFile, nullptr});
+                }
+            }
+        }
 
-                        QDomNodeList xmlNodes = xmlDocument.firstChildElement("resources").childNodes();
-                        for (int i = 0; i < xmlNodes.count(); ++i) {
-                            QDomElement xmlNode = xmlNodes.at(i).toElement();
-                            if (Q_LIKELY(!xmlNode.isNull())) {
+        // Scan the files in parallel for the application label:
 
-                                // Find application label nodes:
+        QtConcurrent::blockingMap(titleFiles, [&labelKey](TitleFile &titleFile) {
+            titleFile.title = TitleNode::scan(titleFile.path, labelKey);
+        });
 
-                                if (xmlNode.nodeName() == "string" && xmlNode.attribute("name") == labelKey) {
-                                    result << new TitleNode(new XmlNode(xmlNode, true), new ResourceFile(resourceFile));
-                                }
-                            } else {
-                                qWarning() << "CRITICAL: Element \"resources\" contains non-element child nodes";
-                            }
-                        }
-                    }
-                }
+        QList<TitleNode *> result;
+        for (const TitleFile &titleFile : qAsConst(titleFiles)) {
+            if (titleFile.title) {
+                result << titleFile.title;
             }
         }
         return result;
@@ -92,8 +80,8 @@ bool TitleItemsModel::setData(const QModelIndex &index, const QVariant &value, i
     if (index.isValid() && role == Qt::EditRole) {
         const int row = index.row();
         TitleNode *title = nodes.at(row);
-        if (title->node->getValue() != value) {
-            title->node->setValue(value.toString());
+        if (title->isEditable() && title->getValue() != value) {
+            title->setValue(value.toString());
             emit dataChanged(index, index);
             return true;
         }
@@ -108,7 +96,7 @@ QVariant TitleItemsModel::data(const QModelIndex &index, int role) const
         if (role == Qt::DisplayRole || role == Qt::EditRole) {
             switch (index.column()) {
             case ValueColumn:
-                return title->node->getValue();
+                return title->getValue();
             case LanguageColumn:
                 return title->file->getLanguageName();
             case QualifiersColumn:
@@ -167,7 +155,8 @@ int TitleItemsModel::columnCount(const QModelIndex &parent) const
 
 Qt::ItemFlags TitleItemsModel::flags(const QModelIndex &index) const
 {
-    if (index.column() == 0) {
+    // Titles containing markup are left read-only, as editing them would flatten the markup:
+    if (index.column() == 0 && index.isValid() && nodes.at(index.row())->isEditable()) {
         return QAbstractItemModel::flags(index) | Qt::ItemIsEditable;
     }
     return QAbstractItemModel::flags(index);
@@ -1,30 +1,161 @@
 #include "apk/titlenode.h"
 #include <QFile>
+#include <QSaveFile>
+#include <QXmlStreamReader>
 #include <QDebug>
 
-TitleNode::TitleNode(XmlNode *node, ResourceFile *file)
+namespace
+{
+    const QByteArray Utf8Bom("\xEF\xBB\xBF");
+}
+
+TitleNode::TitleNode(const QString &key, const QString &value, bool editable, ResourceFile *file)
+    : file(file)
+    , key(key)
+    , value(value)
+    , editable(editable)
+    , modified(false)
 {
-    this->node = node;
-    this->file = file;
 }
 
 TitleNode::~TitleNode()
 {
-    delete node;
     delete file;
 }
 
+TitleNode *TitleNode::scan(const QString &filePath, const QString &key)
+{
+    QFile xml(filePath);
+    if (!xml.open(QFile::ReadOnly)) {
+        return nullptr;
+    }
+    const QByteArray data = xml.readAll();
+
+    // Skip the files which don't mention the key without parsing them:
+    if (!data.contains(key.toUtf8())) {
+        return nullptr;
+    }
+
+    StringElement element;
+    if (!findString(decode(data), key, element)) {
+        return nullptr;
+    }
+    return new TitleNode(key, element.value, !element.hasMarkup, new ResourceFile(filePath));
+}
+
+QString TitleNode::getValue() const
+{
+    return value;
+}
+
+void TitleNode::setValue(const QString &value)
+{
+    if (editable) {
+        this->value = value;
+        modified = true;
+    }
+}
+
+bool TitleNode::isEditable() const
+{
+    return editable;
+}
+
 bool TitleNode::save() const
 {
-    if (node->wasModified()) {
-        QFile xml(file->getFilePath());
-        if (!xml.open(QFile::ReadWrite)) {
-            qWarning() << "Error: Could not save titles resource file";
-            return false;
-        }
-        xml.resize(0);
-        QTextStream stream(&xml);
-        node->getDocument().save(stream, 4);
+    if (!modified) {
+        return true;
+    }
+
+    QFile input(file->getFilePath());
+    if (!input.open(QFile::ReadOnly)) {
+        qWarning() << "Error: Could not read titles resource file";
+        return false;
+    }
+    bool hasBom;
+    QString xml = decode(input.readAll(), &hasBom);
+    input.close();
+
+    // Locate the element again, as the file might have changed since it was scanned:
+    StringElement element;
+    if (!findString(xml, key, element)) {
+        qWarning() << "Error: Could not find the title in resource file";
+        return false;
+    }
+    if (element.hasMarkup) {
+        // Replacing the contents would flatten the markup (e.g., <xliff:g> placeholders):
+        qWarning() << "Error: Could not save the title containing markup";
+        return false;
     }
+
+    // Patch only the value, leaving the rest of the file intact:
+    const QString escapedValue = value.toHtmlEscaped();
+    if (element.isSelfClosing) {
+        xml.replace(element.contentStart - 2, 2, QString(">%1</string>").arg(escapedValue));
+    } else {
+        xml.replace(element.contentStart, element.contentEnd - element.contentStart, escapedValue);
+    }
+
+    QSaveFile output(file->getFilePath());
+    if (!output.open(QFile::WriteOnly) || output.write((hasBom ? Utf8Bom : QByteArray()) + xml.toUtf8()) == -1 || !output.commit()) {
+        qWarning() << "Error: Could not save titles resource file";
+        return false;
+    }
+    modified = false;
     return true;
 }
+
+QString TitleNode::decode(const QByteArray &data, bool *hasBom)
+{
+    // The byte order mark is not a part of the XML text:
+    const bool bom = data.startsWith(Utf8Bom);
+    if (hasBom) {
+        *hasBom = bom;
+    }
+    const int offset = bom ? Utf8Bom.size() : 0;
+    return QString::fromUtf8(data.constData() + offset, data.size() - offset);
+}
+
+bool TitleNode::findString(const QString &xml, const QString &key, StringElement &element)
+{
+    QXmlStreamReader reader(xml);
+    while (!reader.atEnd()) {
+        if (reader.readNext() != QXmlStreamReader::StartElement) {
+            continue;
+        }
+        if (reader.name() == QLatin1String("string") && reader.attributes().value("name") == key) {
+            element.contentStart = static_cast<int>(reader.characterOffset());
+            element.isSelfClosing = xml.midRef(0, element.contentStart).endsWith("/>");
+            element.hasMarkup = false;
+            element.value.clear();
+            for (int depth = 1; depth > 0 && !reader.atEnd();) {
+                switch (reader.readNext()) {
+                case QXmlStreamReader::StartElement:
+                    element.hasMarkup = true;
+                    ++depth;
+                    break;
+                case QXmlStreamReader::EndElement:
+                    --depth;
+                    break;
+                case QXmlStreamReader::Characters:
+                    element.value += reader.text();
+                    break;
+                default:
+                    break;
+                }
+            }
+            if (reader.hasError()) {
+                return false;
+            }
+            element.contentEnd = element.isSelfClosing
+                ? element.contentStart
+                : xml.lastIndexOf("</", static_cast<int>(reader.characterOffset()) - 1);
+            return true;
+        }
+        if (reader.name() != QLatin1String("resources")) {
+            // Don't descend into other resources (e.g., string arrays, plurals or styles):
+            reader.skipCurrentElement();
+        }
+    }
+    return false;
+}
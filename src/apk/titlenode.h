@@ -1,19 +1,42 @@
 #ifndef TITLENODE_H
 #define TITLENODE_H
 
-#include "apk/xmlnode.h"
 #include "apk/resourcefile.h"
 
+// Application title (the <string> resource referenced by "android:label") defined in a single resource file.
+
 class TitleNode
 {
 public:
-    TitleNode(XmlNode *node, ResourceFile *file);
+    TitleNode(const QString &key, const QString &value, bool editable, ResourceFile *file);
     ~TitleNode();
 
+    static TitleNode *scan(const QString &filePath, const QString &key);
+
+    QString getValue() const;
+    void setValue(const QString &value);
+    bool isEditable() const;
     bool save() const;
 
-    XmlNode *node;
     const ResourceFile *file;
+
+private:
+    struct StringElement
+    {
+        int contentStart;
+        int contentEnd;
+        bool isSelfClosing;
+        bool hasMarkup;
+        QString value;
+    };
+
+    static QString decode(const QByteArray &data, bool *hasBom = nullptr);
+    static bool findString(const QString &xml, const QString &key, StringElement &element);
+
+    const QString key;
+    QString value;
+    const bool editable;
+    mutable bool modified;
 };
 
 #endif // TITLENODE_H
@@ -0,0 +1,86 @@
+#include "base/searchfileclassifier.h"
+#include <QFile>
+#include <QSet>
+
+namespace
+{
+    const QSet<QString> textExtensions = {
+        "smali", "xml", "yml", "yaml", "json", "txt", "properties", "html", "htm", "css", "js", "java", "kt", "md"
+    };
+
+    const QSet<QString> binaryExtensions = {
+        "png", "jpg", "jpeg", "gif", "webp", "bmp", "ico", "so", "dex", "jar", "zip", "apk", "arsc",
+        "ttf", "otf", "woff", "mp3", "ogg", "wav", "mp4", "webm"
+    };
+
+    // Magic numbers of common binary formats which contain no zero byte in their signature:
+    const char *binarySignatures[] = {
+        "\x89PNG", "\xFF\xD8\xFF", "GIF8", "RIFF", "PK\x03\x04", "dex\n", "\x7F" "ELF", "OggS", "ID3", "fLaC", "wOFF", "OTTO"
+    };
+
+    const int probeSize = 512;
+
+    QString getExtension(const QString &filePath)
+    {
+        const int slash = filePath.lastIndexOf('/');
+        const int dot = filePath.lastIndexOf('.');
+        return dot > slash ? filePath.mid(dot + 1).toLower() : QString();
+    }
+
+    bool probe(const QString &filePath)
+    {
+        QFile file(filePath);
+        if (!file.open(QFile::ReadOnly)) {
+            return false;
+        }
+        const QByteArray head = file.read(probeSize);
+        if (head.startsWith("\xEF\xBB\xBF") || head.startsWith("\xFF\xFE") || head.startsWith("\xFE\xFF")) {
+            return true;
+        }
+        for (const char *signature : binarySignatures) {
+            if (head.startsWith(signature)) {
+                return false;
+            }
+        }
+        return !head.contains('\0');
+    }
+}
+
+bool SearchFileClassifier::isText(const QString &filePath)
+{
+    {
+        QReadLocker locker(&lock);
+        const auto it = decisions.constFind(filePath);
+        if (it != decisions.constEnd()) {
+            return it.value();
+        }
+    }
+    const bool text = classify(filePath);
+    QWriteLocker locker(&lock);
+    decisions.insert(filePath, text);
+    return text;
+}
+
+void SearchFileClassifier::invalidate(const QString &filePath)
+{
+    QWriteLocker locker(&lock);
+    decisions.remove(filePath);
+}
+
+void SearchFileClassifier::clear()
+{
+    QWriteLocker locker(&lock);
+    decisions.clear();
+}
+
+bool SearchFileClassifier::classify(const QString &filePath)
+{
+    const QString extension = getExtension(filePath);
+    if (textExtensions.contains(extension)) {
+        return true;
+    }
+    if (binaryExtensions.contains(extension)) {
+        return false;
+    }
+    return probe(filePath);
+}
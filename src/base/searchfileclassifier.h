@@ -0,0 +1,23 @@
+#ifndef SEARCHFILECLASSIFIER_H
+#define SEARCHFILECLASSIFIER_H
+
+#include <QHash>
+#include <QReadWriteLock>
+
+// Decides whether a file is searchable text and remembers the decision for the lifetime of a project.
+
+class SearchFileClassifier
+{
+public:
+    bool isText(const QString &filePath);
+    void invalidate(const QString &filePath);
+    void clear();
+
+    static bool classify(const QString &filePath);
+
+private:
+    QReadWriteLock lock;
+    QHash<QString, bool> decisions;
+};
+
+#endif // SEARCHFILECLASSIFIER_H
@@ -0,0 +1,273 @@
+#include "base/searchindex.h"
+#include "base/searchfileclassifier.h"
+#include "base/searchquery.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QtConcurrent/QtConcurrent>
+#include <cstring>
+
+namespace
+{
+    const int TrigramHashShift = 20; // 32 - log2(SignatureBits)
+
+    inline uchar fold(uchar c)
+    {
+        return (c >= 'A' && c <= 'Z') ? uchar(c + ('a' - 'A')) : c;
+    }
+
+    inline bool isLineBreak(uchar c)
+    {
+        return c == '\n' || c == '\r';
+    }
+
+    inline int trigramBit(uchar a, uchar b, uchar c)
+    {
+        const quint32 trigram = quint32(fold(a)) | (quint32(fold(b)) << 8) | (quint32(fold(c)) << 16);
+        return static_cast<int>((trigram * 2654435761u) >> TrigramHashShift);
+    }
+}
+
+SearchIndex::~SearchIndex()
+{
+    clear();
+}
+
+void SearchIndex::build(const QString &directory, SearchFileClassifier *classifier)
+{
+    clear();
+
+    QWriteLocker locker(&lock);
+    this->classifier = classifier;
+    buildCancelRequested = false;
+    buildFuture = QtConcurrent::run([this, directory, classifier]() {
+
+        // Collect text files:
+
+        QStringList paths;
+        QDirIterator files(directory, QDir::Files, QDirIterator::Subdirectories);
+        while (files.hasNext()) {
+            if (buildCancelRequested) {
+                return;
+            }
+            const QString path(files.next());
+            if (classifier ? classifier->isText(path) : SearchFileClassifier::classify(path)) {
+                paths.append(path);
+            }
+        }
+
+        // Compute signatures in parallel:
+
+        QByteArray blob(paths.count() * SignatureSize, '\0');
+        uchar *blobData = reinterpret_cast<uchar *>(blob.data());
+
+        QVector<int> rows(paths.count());
+        QVector<char> indexable(paths.count(), false);
+        char *indexableData = indexable.data();
+        for (int row = 0; row < rows.count(); ++row) {
+            rows[row] = row;
+        }
+        QtConcurrent::blockingMap(rows, [&](int &row) {
+            if (!buildCancelRequested) {
+                indexableData[row] = computeSignature(paths.at(row), blobData + row * SignatureSize);
+            }
+        });
+        if (buildCancelRequested) {
+            return;
+        }
+
+        // Publish the index:
+
+        QWriteLocker locker(&lock);
+        signatures = blob;
+        records.reserve(paths.count());
+        for (int row = 0; row < paths.count(); ++row) {
+            if (indexable.at(row)) {
+                records.insert(key(paths.at(row)), row);
+            }
+        }
+        ready = true;
+
+        // Apply the changes made while the index was being built:
+        const auto updates = pendingUpdates;
+        pendingUpdates.clear();
+        for (const QString &path : updates) {
+            updateLocked(path);
+        }
+    });
+}
+
+void SearchIndex::clear()
+{
+    buildCancelRequested = true;
+    buildFuture.waitForFinished();
+
+    QWriteLocker locker(&lock);
+    ready = false;
+    records.clear();
+    signatures.clear();
+    pendingUpdates.clear();
+}
+
+bool SearchIndex::isReady() const
+{
+    QReadLocker locker(&lock);
+    return ready;
+}
+
+SearchIndex::Filter SearchIndex::createFilter(const SearchQuery &query)
+{
+    Filter filter;
+    if (query.isRegex()) {
+        return filter;
+    }
+
+    const QByteArray bytes = query.pattern().toUtf8();
+    const bool caseSensitive = query.isCaseSensitive();
+    for (int i = 0; i + 2 < bytes.size(); ++i) {
+        const uchar a = bytes.at(i);
+        const uchar b = bytes.at(i + 1);
+        const uchar c = bytes.at(i + 2);
+        // Case-insensitive matching of non-ASCII characters can't be expressed in byte trigrams:
+        if (!caseSensitive && (a >= 0x80 || b >= 0x80 || c >= 0x80)) {
+            continue;
+        }
+        const int bit = trigramBit(a, b, c);
+        if (!filter.contains(bit)) {
+            filter.append(bit);
+        }
+    }
+    return filter;
+}
+
+bool SearchIndex::mayContain(const QString &filePath, const Filter &filter) const
+{
+    if (filter.isEmpty()) {
+        return true;
+    }
+
+    QReadLocker locker(&lock);
+    if (!ready) {
+        return true;
+    }
+    const auto it = records.constFind(key(filePath));
+    if (it == records.constEnd()) {
+        // Files unknown to the index always have to be scanned
+        return true;
+    }
+    const uchar *signature = reinterpret_cast<const uchar *>(signatures.constData()) + it.value() * SignatureSize;
+    for (const int bit : filter) {
+        if (!(signature[bit >> 3] & (1 << (bit & 7)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SearchIndex::update(const QString &filePath)
+{
+    QWriteLocker locker(&lock);
+    if (!ready) {
+        if (!buildFuture.isFinished()) {
+            pendingUpdates.insert(filePath);
+        }
+        return;
+    }
+    updateLocked(filePath);
+}
+
+void SearchIndex::rename(const QString &from, const QString &to)
+{
+    QWriteLocker locker(&lock);
+    if (!ready) {
+        // Paths which are missing from the index are always scanned, so nothing can be lost here
+        return;
+    }
+
+    const QString fromKey = key(from);
+    const QString toKey = key(to);
+    const QString fromPrefix = fromKey + '/';
+
+    QHash<QString, int> renamed;
+    for (auto it = records.begin(); it != records.end();) {
+        if (it.key() == fromKey || it.key().startsWith(fromPrefix)) {
+            renamed.insert(toKey + it.key().mid(fromKey.length()), it.value());
+            it = records.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = renamed.constBegin(); it != renamed.constEnd(); ++it) {
+        records.insert(it.key(), it.value());
+    }
+}
+
+QString SearchIndex::key(const QString &path)
+{
+    return QDir::cleanPath(path);
+}
+
+bool SearchIndex::computeSignature(const QString &filePath, uchar *signature)
+{
+    QFile file(filePath);
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+    const qint64 size = file.size();
+    if (size == 0) {
+        return true;
+    }
+    const uchar *data = file.map(0, size);
+    if (!data) {
+        return false;
+    }
+
+    qint64 start = 0;
+    if (size >= 2 && ((data[0] == 0xFF && data[1] == 0xFE) || (data[0] == 0xFE && data[1] == 0xFF))) {
+        // UTF-16 files are left out of the index and always scanned
+        file.unmap(const_cast<uchar *>(data));
+        return false;
+    }
+    if (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+        start = 3;
+    }
+
+    for (qint64 i = start; i + 2 < size; ++i) {
+        const uchar a = data[i];
+        const uchar b = data[i + 1];
+        const uchar c = data[i + 2];
+        if (isLineBreak(a) || isLineBreak(b) || isLineBreak(c)) {
+            continue;
+        }
+        const int bit = trigramBit(a, b, c);
+        signature[bit >> 3] |= uchar(1 << (bit & 7));
+    }
+
+    file.unmap(const_cast<uchar *>(data));
+    return true;
+}
+
+void SearchIndex::updateLocked(const QString &filePath)
+{
+    const QString path = key(filePath);
+
+    if (classifier) {
+        classifier->invalidate(filePath);
+    }
+    const bool isText = QFile::exists(filePath)
+        && (classifier ? classifier->isText(filePath) : SearchFileClassifier::classify(filePath));
+
+    QByteArray signature(SignatureSize, '\0');
+    if (!isText || !computeSignature(filePath, reinterpret_cast<uchar *>(signature.data()))) {
+        records.remove(path);
+        return;
+    }
+
+    const int row = records.value(path, -1);
+    if (row == -1) {
+        records.insert(path, signatures.size() / SignatureSize);
+        signatures.append(signature);
+    } else {
+        std::memcpy(signatures.data() + row * SignatureSize, signature.constData(), SignatureSize);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QFuture>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QVector>
+#include <atomic>
+
+class SearchFileClassifier;
+class SearchQuery;
+
+// Per-project trigram index used to skip the files which cannot contain a literal query.
+// Every text file gets a fixed-size signature with a bit set for each (ASCII-folded) trigram it contains.
+// The index lives in memory for as long as the project is open, and signatures are updated in place.
+
+class SearchIndex
+{
+public:
+    typedef QVector<int> Filter;
+
+    ~SearchIndex();
+
+    void build(const QString &directory, SearchFileClassifier *classifier = nullptr);
+    void clear();
+    bool isReady() const;
+
+    static Filter createFilter(const SearchQuery &query);
+    bool mayContain(const QString &filePath, const Filter &filter) const;
+
+    void update(const QString &filePath);
+    void rename(const QString &from, const QString &to);
+
+private:
+    static const int SignatureBits = 4096;
+    static const int SignatureSize = SignatureBits / 8;
+
+    static QString key(const QString &path);
+    static bool computeSignature(const QString &filePath, uchar *signature);
+    void updateLocked(const QString &filePath);
+
+    mutable QReadWriteLock lock;
+    QByteArray signatures;
+    QHash<QString, int> records;
+    bool ready = false;
+    QSet<QString> pendingUpdates;
+    SearchFileClassifier *classifier = nullptr;
+
+    QFuture<void> buildFuture;
+    std::atomic<bool> buildCancelRequested{false};
+};
+
+#endif // SEARCHINDEX_H
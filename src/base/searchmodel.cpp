@@ -1,82 +1,206 @@
 #include "base/searchmodel.h"
 #include "base/searchresult.h"
+#include <QSaveFile>
+#include <QSet>
+#include <QTextCodec>
 #include <QtConcurrent/QtConcurrent>
+#include <cstring>
+#include <limits>
 
 // SearchModelWorker
 
+bool SearchModelWorker::validate(const QString &query)
+{
+    // A new search is requested, so the previous one can't be continued anymore, even if this one fails:
+    {
+        QMutexLocker locker(&continuationMutex);
+        hasContinuation = false;
+    }
+
+    const SearchQuery compiledQuery(query, searchCaseSensitive, searchByRegex);
+    if (!compiledQuery.isValid()) {
+        emit searchFailed(compiledQuery.errorString());
+        return false;
+    }
+    return true;
+}
+
 void SearchModelWorker::search(const QString &query, const QString &directory)
 {
     if (query.isEmpty() || directory.isEmpty()) {
         return;
     }
 
-    QtConcurrent::run([this, query, directory]() {
+    SearchState state;
+    state.query = query;
+    state.directory = directory;
+    state.caseSensitive = searchCaseSensitive;
+    state.byRegex = searchByRegex;
+    state.scope = searchScope;
+    startSearch(state);
+}
+
+void SearchModelWorker::searchMore()
+{
+    QMutexLocker locker(&continuationMutex);
+    if (!hasContinuation) {
+        return;
+    }
+    const SearchState state = continuation;
+    locker.unlock();
+    startSearch(state);
+}
+
+void SearchModelWorker::startSearch(const SearchState &state)
+{
+    const SearchQuery compiledQuery(state.query, state.caseSensitive, state.byRegex);
+    if (!compiledQuery.isValid()) {
+        emit searchFailed(compiledQuery.errorString());
+        return;
+    }
+
+    SearchFileClassifier *classifier = fileClassifier;
+    SearchIndex *index = searchIndex;
+    const SearchIndex::Filter filter = index ? SearchIndex::createFilter(compiledQuery) : SearchIndex::Filter();
+    const int maxResults = this->maxResults > 0 ? this->maxResults : std::numeric_limits<int>::max();
+    const int maxFileResults = this->maxFileResults > 0 ? this->maxFileResults : std::numeric_limits<int>::max();
+    const int timeLimit = this->timeLimit;
+    {
+        QMutexLocker locker(&continuationMutex);
+        hasContinuation = false;
+    }
+
+    QtConcurrent::run([=]() {
         searchCancelRequested = false;
         emit searchStarted();
-        int resultCount = 0;
-        int resultFileCount = 0;
-        QMimeDatabase database;
-        QDirIterator files(directory, QDir::Files, QDirIterator::Subdirectories);
-        while (files.hasNext()) {
-            if (searchCancelRequested) {
-                break;
-            }
+        int resultCount = state.resultCount;
+        int resultFileCount = state.resultFileCount;
+        QElapsedTimer elapsedTimer;
+        elapsedTimer.start();
+
+        SearchFileQueue queue;
+        SearchResultBatcher batcher(1000, 100, [this](const QVector<SearchFileMatches> &batch) {
+            emit matchesFound(batch);
+        });
+        SearchResultSequencer sequencer([&](const SearchFileMatches &fileMatches) {
+            resultCount += fileMatches.matches.count();
+            ++resultFileCount;
+            batcher.add(fileMatches);
+            return resultCount - state.resultCount < maxResults;
+        });
+
+        // Start the file scanners:
+
+        QVector<QFuture<void>> scanners;
+        const int scannerCount = qMax(1, scannerPool.maxThreadCount());
+        for (int i = 0; i < scannerCount; ++i) {
+            scanners.append(QtConcurrent::run(&scannerPool, [&]() {
+                int sequence;
+                QString filePath;
+                while (queue.pop(sequence, filePath)) {
+                    if (searchCancelRequested || sequencer.isStopped()) {
+                        queue.close();
+                        break;
+                    }
+                    if (timeLimit > 0 && elapsedTimer.hasExpired(timeLimit)) {
+                        sequencer.stop();
+                        queue.close();
+                        break;
+                    }
+                    const bool isCandidate = (!index || index->mayContain(filePath, filter)) && (classifier
+                        ? classifier->isText(filePath)
+                        : SearchFileClassifier::classify(filePath));
+                    sequencer.complete(sequence, isCandidate
+                        ? scanFile(filePath, compiledQuery, maxFileResults)
+                        : SearchFileMatches{filePath, {}, false});
+                    batcher.flushIfDue();
+                }
+            }));
+        }
 
-            const QString filePath(files.next());
-            emit searchProgressed(filePath);
+        // Walk the directory tree, skipping the files covered by the previous run.
+        // Subtrees out of the search scope are pruned before they are enumerated:
+
+        struct Directory
+        {
+            QString relativePath;
+            bool hasFilesInScope;
+        };
+
+        SearchProgressThrottle progress(100);
+        int walkedFiles = 0;
+        bool walkFinished = true;
+        QVector<Directory> directories;
+        directories.append({QString(), state.scope.matchDirectory(QString()) == SearchScope::DirectoryIncluded});
+        while (walkFinished && !directories.isEmpty()) {
+            const Directory directory = directories.takeLast();
+            const bool isRoot = directory.relativePath.isEmpty();
+            const QString prefix = isRoot ? QString() : directory.relativePath + '/';
+            const QString path = isRoot ? state.directory : state.directory + '/' + directory.relativePath;
+            QVector<Directory> subdirectories;
+
+            QDirIterator entries(path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+            while (entries.hasNext()) {
+                if (searchCancelRequested) {
+                    walkFinished = false;
+                    break;
+                }
 
-            if (!database.mimeTypeForFile(filePath).inherits("text/plain")) {
-                continue;
-            }
+                const QString filePath(entries.next());
+                const QString relativePath = prefix + entries.fileName();
 
-            QFile file(filePath);
-            if (file.open(QFile::ReadOnly)) {
-                QTextStream stream(&file);
-                stream.setCodec("UTF-8");
-                int currentLineNumber = 0;
-                bool fileHasResult = false;
-
-                while (!stream.atEnd()) {
-                    ++currentLineNumber;
-                    const QString line = stream.readLine();
-                    int matchOffset = 0;
-
-                    forever {
-                        QString match;
-                        int matchStart = -1;
-                        int matchLength = 0;
-
-                        if (!searchByRegex) {
-                            const auto caseSensitivity = searchCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
-                            matchStart = line.indexOf(query, matchOffset, caseSensitivity);
-                            matchLength = query.length();
-                        } else {
-                            auto regex = QRegularExpression(query);
-                            if (!searchCaseSensitive) {
-                                regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
-                            }
-                            const auto match = regex.match(line, matchOffset);
-                            matchStart = match.capturedStart(1);
-                            matchLength = match.capturedLength(1);
-                        }
-
-                        if (matchStart == -1) {
-                            break;
-                        }
-
-                        emit matchFound(filePath, line, currentLineNumber, matchStart, matchLength);
-                        ++resultCount;
-                        if (!fileHasResult) {
-                            ++resultFileCount;
-                            fileHasResult = true;
-                        }
-                        matchOffset = matchStart + matchLength;
+                if (entries.fileInfo().isDir()) {
+                    const auto match = state.scope.matchDirectory(relativePath);
+                    if (match != SearchScope::DirectoryExcluded) {
+                        subdirectories.append({relativePath, match == SearchScope::DirectoryIncluded});
                     }
+                    continue;
                 }
+                if (!directory.hasFilesInScope || !state.scope.matchFile(relativePath)) {
+                    continue;
+                }
+
+                if (walkedFiles++ < state.skippedFiles) {
+                    continue;
+                }
+                if (progress.isDue()) {
+                    emit searchProgressed(filePath);
+                }
+
+                if (!queue.push(filePath)) {
+                    walkFinished = false;
+                    break;
+                }
+            }
+
+            // Keep the depth-first order:
+            for (auto it = subdirectories.crbegin(); it != subdirectories.crend(); ++it) {
+                directories.append(*it);
+            }
+        }
+
+        queue.close();
+        for (auto &scanner : scanners) {
+            scanner.waitForFinished();
+        }
+        batcher.flush();
+
+        // Remember where the scan stopped if a limit has been reached:
+        bool hasMore = false;
+        if (!searchCancelRequested && sequencer.isStopped()) {
+            const int scannedFiles = state.skippedFiles + sequencer.stop();
+            hasMore = !walkFinished || scannedFiles < walkedFiles;
+            if (hasMore) {
+                QMutexLocker locker(&continuationMutex);
+                continuation = state;
+                continuation.skippedFiles = scannedFiles;
+                continuation.resultCount = resultCount;
+                continuation.resultFileCount = resultFileCount;
+                hasContinuation = true;
             }
         }
 
-        emit searchFinished(resultCount, resultFileCount);
+        emit searchFinished(resultCount, resultFileCount, hasMore);
     });
 }
 
@@ -87,141 +211,350 @@ void SearchModelWorker::cancelSearch()
 
 void SearchModelWorker::replace(const QList<SearchResultFile *> &resultFiles, const QString &with)
 {
-    QtConcurrent::run([this, resultFiles, with]() {
-        int totalFilesReplaced = 0;
-        int totalResultsReplaced = 0;
-        bool success = true;
+    SearchIndex *index = searchIndex;
 
+    QtConcurrent::run([this, resultFiles, with, index]() {
         replaceCancelRequested = false;
         emit replaceStarted();
 
-        for (const auto &resultFile : resultFiles) {
-            if (replaceCancelRequested) {
-                break;
-            }
+        std::atomic<int> nextFile{0};
+        std::atomic<int> totalFilesReplaced{0};
+        std::atomic<int> totalResultsReplaced{0};
+        std::atomic<bool> success{true};
+        SearchProgressThrottle progress(100);
+
+        // Every file is rewritten by a single replacer, so no result is shared between threads:
+
+        QVector<QFuture<void>> replacers;
+        const int replacerCount = qMax(1, qMin(scannerPool.maxThreadCount(), resultFiles.count()));
+        for (int i = 0; i < replacerCount; ++i) {
+            replacers.append(QtConcurrent::run(&scannerPool, [&]() {
+                int fileIndex;
+                while ((fileIndex = nextFile++) < resultFiles.count()) {
+                    if (replaceCancelRequested) {
+                        break;
+                    }
 
-            if (resultFile->getCheckState() == Qt::Unchecked) {
-                continue;
-            }
+                    const auto resultFile = resultFiles.at(fileIndex);
+                    if (resultFile->getCheckState() == Qt::Unchecked) {
+                        continue;
+                    }
 
-            const auto filePath = resultFile->path;
-            emit replaceProgressed(filePath);
+                    if (progress.isDue()) {
+                        emit replaceProgressed(resultFile->path);
+                    }
 
-            QFile inputFile(filePath);
-            if (!inputFile.open(QFile::ReadOnly)) {
-                qWarning() << "Could not open the original match file.";
-                success = false;
-                continue;
-            }
-            QTextStream inputStream(&inputFile);
-            inputStream.setCodec("UTF-8");
+                    QVector<SearchResult> results = resultFile->results;
+                    QVector<int> replacedRows;
+                    if (!replaceInFile(resultFile->path, with, results, replacedRows)) {
+                        success = false;
+                    }
+                    if (replacedRows.isEmpty()) {
+                        continue;
+                    }
+                    if (index) {
+                        index->update(resultFile->path);
+                    }
 
-            QTemporaryFile outputFile(filePath);
-            if (!outputFile.open()) {
-                qWarning() << "Could not open the temporary match file.";
-                success = false;
-                continue;
-            }
-            QTextStream outputStream(&outputFile);
+                    ++totalFilesReplaced;
+                    totalResultsReplaced += replacedRows.count();
 
-            int currentLineNumber = 0;
-            QList<SearchResult *> unsavedResults;
+                    emit resultsReplaced(resultFile, results, replacedRows);
+                }
+            }));
+        }
 
-            while (!inputStream.atEnd()) {
-                auto results = resultFile->results;
-                QString line = inputStream.readLine();
-                ++currentLineNumber;
+        for (auto &replacer : replacers) {
+            replacer.waitForFinished();
+        }
 
-                for (auto itResult = results.begin(); itResult != results.end(); ++itResult) {
-                    const auto result = *itResult;
+        emit replaceFinished(totalResultsReplaced, totalFilesReplaced, success);
+    });
+}
 
-                    if (result->lineNumber != currentLineNumber || result->checkState != Qt::Checked) {
-                        continue;
-                    }
+void SearchModelWorker::cancelReplace()
+{
+    replaceCancelRequested = true;
+}
 
-                    if (!result->matches(line)) {
-                        // File has been modified, and the search result doesn't match anymore
-                        success = false;
-                        continue;
-                    }
+void SearchModelWorker::setSearchCaseSensitive(bool enabled)
+{
+    searchCaseSensitive = enabled;
+}
 
-                    const int matchStartOffset = result->match().length() - with.length();
+void SearchModelWorker::setSearchByRegex(bool enabled)
+{
+    searchByRegex = enabled;
+}
 
-                    line.replace(result->matchStart, result->matchLength, with);
+void SearchModelWorker::setFileClassifier(SearchFileClassifier *classifier)
+{
+    fileClassifier = classifier;
+}
 
-                    // Offset the match ranges for results in the same line
-                    for (auto itNextResult = itResult + 1; itNextResult != results.end(); ++itNextResult) {
-                        auto nextResult = *itNextResult;
-                        if (nextResult->lineNumber != currentLineNumber) {
-                            break;
-                        }
-                        nextResult->lineContent = line;
-                        nextResult->matchStart -= matchStartOffset;
-                        emit matchUpdated(resultFile, nextResult);
-                    }
+void SearchModelWorker::setSearchIndex(SearchIndex *index)
+{
+    searchIndex = index;
+}
 
-                    unsavedResults << result;
-                }
-                outputStream.setCodec(inputStream.codec());
-                outputStream << line << Qt::endl;
+void SearchModelWorker::setSearchScope(const SearchScope &scope)
+{
+    searchScope = scope;
+}
+
+void SearchModelWorker::setResultLimits(int maxResults, int maxFileResults, int timeLimit)
+{
+    this->maxResults = maxResults;
+    this->maxFileResults = maxFileResults;
+    this->timeLimit = timeLimit;
+}
+
+bool SearchModelWorker::replaceInFile(const QString &filePath, const QString &with,
+                                      QVector<SearchResult> &results, QVector<int> &replacedRows)
+{
+    QFile inputFile(filePath);
+    if (!inputFile.open(QFile::ReadOnly)) {
+        qWarning() << "Could not open the original match file.";
+        return false;
+    }
+    const QByteArray data = inputFile.readAll();
+    inputFile.close();
+
+    // Keep the original encoding and byte order mark:
+
+    QTextCodec *codec = QTextCodec::codecForUtfText(data, QTextCodec::codecForName("UTF-8"));
+    int headerSize = 0;
+    if (data.startsWith(QByteArray("\xFF\xFE\0\0", 4)) || data.startsWith(QByteArray("\0\0\xFE\xFF", 4))) {
+        headerSize = 4;
+    } else if (data.startsWith("\xEF\xBB\xBF")) {
+        headerSize = 3;
+    } else if (data.startsWith("\xFF\xFE") || data.startsWith("\xFE\xFF")) {
+        headerSize = 2;
+    }
+    QTextCodec::ConverterState decoderState(QTextCodec::IgnoreHeader);
+    const QString text = codec->toUnicode(data.constData() + headerSize, data.size() - headerSize, &decoderState);
+
+    // Rebuild the contents in one pass, copying the untouched ranges (including line endings) as is:
+
+    QString output;
+    output.reserve(text.size());
+    int copiedUntil = 0;
+    int lineStart = 0;
+    int lineNumber = 1;
+    bool success = true;
+
+    for (int first = 0; first < results.count();) {
+        const int targetLineNumber = results.at(first).lineNumber;
+        int last = first;
+        while (last < results.count() && results.at(last).lineNumber == targetLineNumber) {
+            ++last;
+        }
+
+        while (lineNumber < targetLineNumber) {
+            const int newline = text.indexOf('\n', lineStart);
+            if (newline == -1) {
+                break;
             }
+            lineStart = newline + 1;
+            ++lineNumber;
+        }
+        if (lineNumber != targetLineNumber) {
+            // File has been truncated since the search
+            success = false;
+            break;
+        }
 
-            if (!inputFile.remove()) {
-                qWarning() << "Could not remove the original match file.";
-                success = false;
+        int lineEnd = text.indexOf('\n', lineStart);
+        if (lineEnd == -1) {
+            lineEnd = text.size();
+        }
+        if (lineEnd > lineStart && text.at(lineEnd - 1) == '\r') {
+            --lineEnd;
+        }
+        QString line = text.mid(lineStart, lineEnd - lineStart);
+
+        for (int i = first; i < last; ++i) {
+            const auto &result = results.at(i);
+            if (result.checkState != Qt::Checked) {
                 continue;
             }
 
-            if (outputFile.rename(filePath)) {
-                outputFile.setAutoRemove(false);
-            } else {
-                qWarning() << "Could not move the temporary match file.";
+            if (!result.matches(line)) {
+                // File has been modified, and the search result doesn't match anymore
                 success = false;
                 continue;
             }
 
-            totalFilesReplaced += 1;
-            totalResultsReplaced += unsavedResults.count();
+            const int matchStartOffset = result.matchLength - with.length();
+
+            line.replace(result.matchStart, result.matchLength, with);
 
-            for (const auto &result : qAsConst(unsavedResults)) {
-                emit matchReplaced(resultFile, result);
+            // Offset the match ranges for results in the same line
+            for (int j = i + 1; j < last; ++j) {
+                results[j].matchStart -= matchStartOffset;
             }
+
+            replacedRows << i;
         }
 
-        emit replaceFinished(totalResultsReplaced, totalFilesReplaced, success);
-    });
+        output.append(text.midRef(copiedUntil, lineStart - copiedUntil));
+        output.append(line);
+        copiedUntil = lineEnd;
+        first = last;
+    }
+
+    if (replacedRows.isEmpty()) {
+        return success;
+    }
+    output.append(text.midRef(copiedUntil));
+
+    QTextCodec::ConverterState encoderState(QTextCodec::IgnoreHeader);
+    const QByteArray encoded = codec->fromUnicode(output.constData(), output.size(), &encoderState);
+
+    QSaveFile outputFile(filePath);
+    if (!outputFile.open(QFile::WriteOnly)
+            || outputFile.write(data.constData(), headerSize) != headerSize
+            || outputFile.write(encoded) != encoded.size()
+            || !outputFile.commit()) {
+        qWarning() << "Could not write the match file.";
+        replacedRows.clear();
+        return false;
+    }
+    return success;
 }
 
-void SearchModelWorker::cancelReplace()
+SearchFileMatches SearchModelWorker::scanFile(const QString &filePath, const SearchQuery &query, int maxMatches) const
 {
-    replaceCancelRequested = true;
+    SearchFileMatches fileMatches;
+    fileMatches.filePath = filePath;
+    fileMatches.truncated = false;
+
+    QFile file(filePath);
+    if (!file.open(QFile::ReadOnly)) {
+        return fileMatches;
+    }
+
+    if (!query.isByteSearchable() || !scanMappedFile(file, query, maxMatches, fileMatches)) {
+        scanTextFile(file, query, maxMatches, fileMatches);
+    }
+    return fileMatches;
 }
 
-void SearchModelWorker::setSearchCaseSensitive(bool enabled)
+bool SearchModelWorker::scanMappedFile(QFile &file, const SearchQuery &query, int maxMatches, SearchFileMatches &fileMatches) const
 {
-    searchCaseSensitive = enabled;
+    const qint64 fileSize = file.size();
+    if (fileSize == 0) {
+        return true;
+    }
+    if (fileSize > std::numeric_limits<int>::max()) {
+        return false;
+    }
+
+    uchar *map = file.map(0, fileSize);
+    if (!map) {
+        return false;
+    }
+
+    const char *data = reinterpret_cast<const char *>(map);
+    const int size = static_cast<int>(fileSize);
+    int position = 0;
+
+    // UTF-16 files need to be decoded first; UTF-8 BOM is skipped:
+    if (size >= 2 && ((data[0] == '\xFF' && data[1] == '\xFE') || (data[0] == '\xFE' && data[1] == '\xFF'))) {
+        file.unmap(map);
+        return false;
+    }
+    if (size >= 3 && data[0] == '\xEF' && data[1] == '\xBB' && data[2] == '\xBF') {
+        position = 3;
+    }
+
+    // Only the lines containing a raw byte match are decoded:
+
+    int lineNumber = 1;
+    int lineStart = position;
+    int countedUntil = position;
+    int hit;
+
+    while ((hit = query.findIn(data, size, position)) != -1) {
+        if (searchCancelRequested || fileMatches.truncated) {
+            break;
+        }
+
+        const char *newline;
+        while ((newline = static_cast<const char *>(std::memchr(data + countedUntil, '\n', hit - countedUntil)))) {
+            ++lineNumber;
+            countedUntil = lineStart = static_cast<int>(newline - data) + 1;
+        }
+
+        newline = static_cast<const char *>(std::memchr(data + hit, '\n', size - hit));
+        const int lineEnd = newline ? static_cast<int>(newline - data) : size;
+        int lineLength = lineEnd - lineStart;
+        if (lineLength > 0 && data[lineStart + lineLength - 1] == '\r') {
+            --lineLength;
+        }
+
+        matchLine(QString::fromUtf8(data + lineStart, lineLength), lineNumber, query, maxMatches, fileMatches);
+
+        if (!newline) {
+            break;
+        }
+        countedUntil = position = lineEnd;
+    }
+
+    file.unmap(map);
+    return true;
 }
 
-void SearchModelWorker::setSearchByRegex(bool enabled)
+void SearchModelWorker::scanTextFile(QFile &file, const SearchQuery &query, int maxMatches, SearchFileMatches &fileMatches) const
 {
-    searchByRegex = enabled;
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    int currentLineNumber = 0;
+
+    while (!stream.atEnd()) {
+        if (searchCancelRequested || fileMatches.truncated) {
+            break;
+        }
+        matchLine(stream.readLine(), ++currentLineNumber, query, maxMatches, fileMatches);
+    }
+}
+
+void SearchModelWorker::matchLine(const QString &line, int lineNumber, const SearchQuery &query,
+                                  int maxMatches, SearchFileMatches &fileMatches)
+{
+    int matchOffset = 0;
+    int matchStart;
+    int matchLength;
+    while (query.match(line, matchOffset, matchStart, matchLength)) {
+        if (fileMatches.matches.count() >= maxMatches) {
+            // Scanning stops at the first match over the limit, which only marks the file as truncated:
+            fileMatches.truncated = true;
+            break;
+        }
+        fileMatches.matches.append({line, lineNumber, matchStart, matchLength});
+        matchOffset = matchStart + matchLength;
+    }
 }
 
 // SearchModel
 
 SearchModel::SearchModel(QObject *parent) : QAbstractItemModel(parent)
 {
+    qRegisterMetaType<QVector<SearchFileMatches>>("QVector<SearchFileMatches>");
+    qRegisterMetaType<SearchResultFile *>("SearchResultFile *");
+    qRegisterMetaType<QVector<SearchResult>>("QVector<SearchResult>");
+
     connect(&worker, &SearchModelWorker::searchStarted, this, &SearchModel::searchStarted);
     connect(&worker, &SearchModelWorker::searchProgressed, this, &SearchModel::searchProgressed);
     connect(&worker, &SearchModelWorker::searchFinished, this, &SearchModel::searchFinished);
+    connect(&worker, &SearchModelWorker::searchFailed, this, &SearchModel::searchFailed);
 
     connect(&worker, &SearchModelWorker::replaceStarted, this, &SearchModel::replaceStarted);
     connect(&worker, &SearchModelWorker::replaceProgressed, this, &SearchModel::replaceProgressed);
     connect(&worker, &SearchModelWorker::replaceFinished, this, &SearchModel::replaceFinished);
 
-    connect(&worker, &SearchModelWorker::matchFound, this, &SearchModel::add);
-    connect(&worker, &SearchModelWorker::matchReplaced, this, &SearchModel::remove);
-    connect(&worker, &SearchModelWorker::matchUpdated, this, &SearchModel::update);
+    connect(&worker, &SearchModelWorker::matchesFound, this, &SearchModel::add);
+    connect(&worker, &SearchModelWorker::resultsReplaced, this, &SearchModel::applyReplaced);
 }
 
 SearchModel::~SearchModel()
@@ -235,20 +568,10 @@ bool SearchModel::isResultIndex(const QModelIndex &index)
     return indexType != RootIndex && indexType != ResultFileIndex;
 }
 
-void SearchModel::add(const QString &filePath, const QString &lineContent, int lineNumber, int matchStart, int matchLength)
+void SearchModel::add(const QVector<SearchFileMatches> &fileMatches)
 {
-    SearchResult *result = new SearchResult(filePath, lineContent, lineNumber, matchStart, matchLength);
-    SearchResultFile *resultFile = nullptr;
-
-    const auto rootIndex = index(0, 0);
-    int resultFileRow;
-
-    for (resultFileRow = resultFiles.count() - 1; resultFileRow >= 0; --resultFileRow) {
-        auto existingResultFile = resultFiles.at(resultFileRow);
-        if (existingResultFile->path == result->filePath) {
-            resultFile = existingResultFile;
-            break;
-        }
+    if (fileMatches.isEmpty()) {
+        return;
     }
 
     if (resultFiles.isEmpty()) {
@@ -257,46 +580,91 @@ void SearchModel::add(const QString &filePath, const QString &lineContent, int l
         endInsertRows();
     }
 
-    if (!resultFile) {
-        resultFile = new SearchResultFile(result->filePath);
-        const int row = resultFiles.count();
-        beginInsertRows(rootIndex, row, row);
-        resultFiles.append(resultFile);
-        ++totalResultFiles;
-    } else {
-        const auto resultFileIndex = index(resultFileRow, 0, rootIndex);
-        const int row = resultFile->results.count();
-        beginInsertRows(resultFileIndex, row, row);
+    const auto rootIndex = index(0, 0);
+    QList<SearchResultFile *> newResultFiles;
+    QSet<QString> matchTexts;
+
+    for (const auto &block : fileMatches) {
+        if (block.matches.isEmpty()) {
+            continue;
+        }
+
+        QVector<SearchResult> results;
+        results.reserve(block.matches.count());
+        for (const auto &match : block.matches) {
+            // Share the data of equal matched strings:
+            const QString matchText = *matchTexts.insert(match.lineContent.mid(match.matchStart, match.matchLength));
+            results.append({match.lineNumber, match.matchStart, match.matchLength, matchText, Qt::Checked});
+        }
+        totalResults += results.count();
+
+        const int resultFileRow = resultFileRows.value(block.filePath, -1);
+        if (resultFileRow >= resultFiles.count()) {
+            // Append to the file added earlier in this batch:
+            auto resultFile = newResultFiles.at(resultFileRow - resultFiles.count());
+            resultFile->results += results;
+            resultFile->truncated = block.truncated;
+        } else if (resultFileRow != -1) {
+            // Append to the already listed file:
+            auto resultFile = resultFiles.at(resultFileRow);
+            const auto resultFileIndex = index(resultFileRow, 0, rootIndex);
+            const int row = resultFile->results.count();
+            beginInsertRows(resultFileIndex, row, row + results.count() - 1);
+            resultFile->results += results;
+            resultFile->truncated = block.truncated;
+            endInsertRows();
+        } else {
+            auto resultFile = new SearchResultFile(block.filePath);
+            resultFile->results = results;
+            resultFile->truncated = block.truncated;
+            resultFileRows.insert(block.filePath, resultFiles.count() + newResultFiles.count());
+            newResultFiles.append(resultFile);
+        }
     }
 
-    resultFile->results.append(result);
-    endInsertRows();
+    if (!newResultFiles.isEmpty()) {
+        const int firstRow = resultFiles.count();
+        beginInsertRows(rootIndex, firstRow, firstRow + newResultFiles.count() - 1);
+        resultFiles.append(newResultFiles);
+        totalResultFiles += newResultFiles.count();
+        endInsertRows();
+    }
 
-    ++totalResults;
     emit dataChanged(rootIndex, rootIndex, {Qt::DisplayRole});
 }
 
-void SearchModel::remove(SearchResultFile *resultFile, SearchResult *result)
+void SearchModel::applyReplaced(SearchResultFile *resultFile, const QVector<SearchResult> &results, const QVector<int> &replacedRows)
 {
-    const int resultFileRow = resultFiles.indexOf(resultFile);
+    const int resultFileRow = resultFileRows.value(resultFile->path, -1);
     Q_ASSERT(resultFileRow != -1);
-
-    const int resultRow = resultFile->results.indexOf(result);
-    Q_ASSERT(resultRow != -1);
+    Q_ASSERT(results.count() == resultFile->results.count());
 
     const auto rootIndex = index(0, 0);
     const auto resultFileIndex = index(resultFileRow, 0, rootIndex);
     Q_ASSERT(resultFileIndex.isValid());
 
-    if (resultFile->results.size() > 1) {
-        // Remove a single search result
-        beginRemoveRows(resultFileIndex, resultRow, resultRow);
-        delete resultFile->results.takeAt(resultRow);
-        endRemoveRows();
+    // Line contents and match offsets have changed:
+    lineCache.invalidate(resultFile->path);
+
+    if (replacedRows.count() < resultFile->results.count()) {
+        resultFile->results = results;
+        // Remove the replaced search results (from the bottom, so that the rows stay valid)
+        for (int i = replacedRows.count() - 1; i >= 0; --i) {
+            const int resultRow = replacedRows.at(i);
+            beginRemoveRows(resultFileIndex, resultRow, resultRow);
+            resultFile->results.remove(resultRow);
+            endRemoveRows();
+        }
+        emit dataChanged(index(0, 0, resultFileIndex), index(resultFile->results.count() - 1, 0, resultFileIndex));
+        emit dataChanged(resultFileIndex, resultFileIndex);
     } else {
         // Remove the whole search result file
         beginRemoveRows(rootIndex, resultFileRow, resultFileRow);
+        resultFileRows.remove(resultFile->path);
         delete resultFiles.takeAt(resultFileRow);
+        for (int row = resultFileRow; row < resultFiles.count(); ++row) {
+            resultFileRows[resultFiles.at(row)->path] = row;
+        }
         --totalResultFiles;
         endRemoveRows();
     }
@@ -307,33 +675,17 @@ void SearchModel::remove(SearchResultFile *resultFile, SearchResult *result)
         endRemoveRows();
     }
 
-    --totalResults;
+    totalResults -= replacedRows.count();
     emit dataChanged(rootIndex, rootIndex, {Qt::DisplayRole});
 }
 
-void SearchModel::update(SearchResultFile *resultFile, SearchResult *result)
-{
-    const int resultFileRow = resultFiles.indexOf(resultFile);
-    Q_ASSERT(resultFileRow != -1);
-
-    const int resultRow = resultFile->results.indexOf(result);
-    Q_ASSERT(resultRow != -1);
-
-    const auto rootIndex = index(0, 0);
-    const auto resultFileIndex = index(resultFileRow, 0, rootIndex);
-    Q_ASSERT(resultFileIndex.isValid());
-
-    const auto resultIndex = index(resultRow, 0, resultFileIndex);
-    Q_ASSERT(resultIndex.isValid());
-
-    emit dataChanged(resultIndex, resultIndex);
-}
-
 void SearchModel::clear()
 {
     beginResetModel();
     qDeleteAll(resultFiles);
     resultFiles.clear();
+    resultFileRows.clear();
+    lineCache.clear();
     totalResults = 0;
     totalResultFiles = 0;
     isRootVisible = false;
@@ -346,10 +698,19 @@ void SearchModel::search(const QString &query, const QString &directory)
         return;
     }
 
+    // Keep the current results if the query is invalid:
+    if (!worker.validate(query)) {
+        return;
+    }
     clear();
     worker.search(query, directory);
 }
 
+void SearchModel::searchMore()
+{
+    worker.searchMore();
+}
+
 void SearchModel::cancelSearch()
 {
     worker.cancelSearch();
@@ -403,6 +764,26 @@ void SearchModel::setSearchByRegex(bool enabled)
     worker.setSearchByRegex(enabled);
 }
 
+void SearchModel::setFileClassifier(SearchFileClassifier *classifier)
+{
+    worker.setFileClassifier(classifier);
+}
+
+void SearchModel::setSearchIndex(SearchIndex *index)
+{
+    worker.setSearchIndex(index);
+}
+
+void SearchModel::setSearchScope(const SearchScope &scope)
+{
+    worker.setSearchScope(scope);
+}
+
+void SearchModel::setResultLimits(int maxResults, int maxFileResults, int timeLimit)
+{
+    worker.setResultLimits(maxResults, maxFileResults, timeLimit);
+}
+
 QVariant SearchModel::data(const QModelIndex &index, int role) const
 {
     if (!index.isValid()) {
@@ -434,12 +815,20 @@ QVariant SearchModel::data(const QModelIndex &index, int role) const
 
         switch (role) {
         case Qt::DisplayRole: {
-            const QString caption = QString("%1 (%2)").arg(resultFile->path).arg(resultFile->results.count());
+            const int count = resultFile->results.count();
+            const QString caption = QString("%1 (%2)").arg(resultFile->path,
+                resultFile->truncated ? QString("%1+").arg(count) : QString::number(count));
             if (caption.startsWith(rootPath)) {
                 return caption.mid(rootPath.length());
             }
             return caption;
         }
+        case Qt::ToolTipRole:
+            if (resultFile->truncated) {
+                //: "%1" will be replaced with the maximum number of results per file.
+                return tr("Only the first %1 results are shown for this file.").arg(resultFile->results.count());
+            }
+            break;
         case Qt::CheckStateRole:
             return resultFile->getCheckState();
         case FilePathRole:
@@ -465,19 +854,19 @@ QVariant SearchModel::data(const QModelIndex &index, int role) const
 
     switch (role) {
     case Qt::DisplayRole:
-        return result->lineContent;
+        return lineCache.line(resultFile, result.lineNumber);
     case Qt::CheckStateRole:
-        return result->checkState;
+        return result.checkState;
     case FilePathRole:
-        return result->filePath;
+        return resultFile->path;
     case LineNumberRole:
-        return result->lineNumber;
+        return result.lineNumber;
     case LineNumberLengthRole:
         return resultFile->lastLineNumberLength();
     case MatchStartRole:
-        return result->matchStart;
+        return result.matchStart;
     case MatchLengthRole:
-        return result->matchLength;
+        return result.matchLength;
     }
 
     return QVariant();
@@ -524,7 +913,7 @@ bool SearchModel::setData(const QModelIndex &index, const QVariant &value, int r
             const auto parentRow = index.internalId();
             const auto resultFile = resultFiles.at(parentRow);
             Q_ASSERT(resultFile);
-            resultFile->results[row]->checkState = static_cast<Qt::CheckState>(value.toInt());
+            resultFile->results[row].checkState = static_cast<Qt::CheckState>(value.toInt());
             emit dataChanged(index, index, {Qt::CheckStateRole});
             emit dataChanged(index.parent(), index.parent(), {Qt::CheckStateRole});
             emit dataChanged(rootIndex, rootIndex, {Qt::CheckStateRole});
@@ -1,15 +1,27 @@
 #ifndef SEARCHMODEL_H
 #define SEARCHMODEL_H
 
+#include "base/searchfileclassifier.h"
+#include "base/searchindex.h"
+#include "base/searchpipeline.h"
+#include "base/searchquery.h"
 #include "base/searchresult.h"
+#include "base/searchscope.h"
 #include <QAbstractItemModel>
+#include <QMutex>
+#include <QThreadPool>
+#include <atomic>
+
+class QFile;
 
 class SearchModelWorker : public QObject
 {
     Q_OBJECT
 
 public:
+    bool validate(const QString &query);
     void search(const QString &query, const QString &directory);
+    void searchMore();
     void cancelSearch();
 
     void replace(const QList<SearchResultFile *> &resultFiles, const QString &with);
@@ -17,26 +29,64 @@ public:
 
     void setSearchCaseSensitive(bool enabled);
     void setSearchByRegex(bool enabled);
+    void setFileClassifier(SearchFileClassifier *classifier);
+    void setSearchIndex(SearchIndex *index);
+    void setSearchScope(const SearchScope &scope);
+    void setResultLimits(int maxResults, int maxFileResults, int timeLimit);
 
 signals:
     void searchStarted();
     void searchProgressed(const QString &currentFile);
-    void searchFinished(int resultCount, int fileCount);
+    void searchFinished(int resultCount, int fileCount, bool hasMore);
+    void searchFailed(const QString &error);
 
     void replaceStarted();
     void replaceProgressed(const QString &currentFile);
     void replaceFinished(int resultCount, int fileCount, bool allSucceeded);
 
-    void matchFound(const QString &filePath, const QString &lineContent, int lineNumber, int matchStart, int matchLength);
-    void matchReplaced(SearchResultFile *resultFile, SearchResult *result);
-    void matchUpdated(SearchResultFile *resultFile, SearchResult *result);
+    void matchesFound(const QVector<SearchFileMatches> &fileMatches);
+    void resultsReplaced(SearchResultFile *resultFile, const QVector<SearchResult> &results, const QVector<int> &replacedRows);
 
 private:
+    struct SearchState
+    {
+        QString query;
+        QString directory;
+        bool caseSensitive = false;
+        bool byRegex = false;
+        SearchScope scope;
+        int skippedFiles = 0;
+        int resultCount = 0;
+        int resultFileCount = 0;
+    };
+
+    void startSearch(const SearchState &state);
+    static bool replaceInFile(const QString &filePath, const QString &with,
+                       QVector<SearchResult> &results, QVector<int> &replacedRows);
+    SearchFileMatches scanFile(const QString &filePath, const SearchQuery &query, int maxMatches) const;
+    bool scanMappedFile(QFile &file, const SearchQuery &query, int maxMatches, SearchFileMatches &fileMatches) const;
+    void scanTextFile(QFile &file, const SearchQuery &query, int maxMatches, SearchFileMatches &fileMatches) const;
+    static void matchLine(const QString &line, int lineNumber, const SearchQuery &query,
+                          int maxMatches, SearchFileMatches &fileMatches);
+
     bool searchCaseSensitive = false;
     bool searchByRegex = false;
-
-    bool searchCancelRequested = true;
-    bool replaceCancelRequested = true;
+    SearchFileClassifier *fileClassifier = nullptr;
+    SearchIndex *searchIndex = nullptr;
+    SearchScope searchScope;
+    int maxResults = 0;
+    int maxFileResults = 0;
+    int timeLimit = 0;
+
+    // State of the last search stopped by a limit (written by the search thread):
+    QMutex continuationMutex;
+    SearchState continuation;
+    bool hasContinuation = false;
+
+    std::atomic<bool> searchCancelRequested{true};
+    std::atomic<bool> replaceCancelRequested{true};
+
+    QThreadPool scannerPool;
 };
 
 class SearchModel : public QAbstractItemModel
@@ -63,12 +113,12 @@ public:
 
     static bool isResultIndex(const QModelIndex &index);
 
-    void add(const QString &filePath, const QString &lineContent, int lineNumber, int matchStart, int matchLength);
-    void remove(SearchResultFile *resultFile, SearchResult *result);
-    void update(SearchResultFile *resultFile, SearchResult *result);
+    void add(const QVector<SearchFileMatches> &fileMatches);
+    void applyReplaced(SearchResultFile *resultFile, const QVector<SearchResult> &results, const QVector<int> &replacedRows);
     void clear();
 
     void search(const QString &query, const QString &directory);
+    void searchMore();
     void cancelSearch();
 
     void replace(const QString &with);
@@ -79,6 +129,10 @@ public:
 
     void setSearchCaseSensitive(bool enabled);
     void setSearchByRegex(bool enabled);
+    void setFileClassifier(SearchFileClassifier *classifier);
+    void setSearchIndex(SearchIndex *index);
+    void setSearchScope(const SearchScope &scope);
+    void setResultLimits(int maxResults, int maxFileResults, int timeLimit);
 
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
@@ -91,7 +145,8 @@ public:
 signals:
     void searchStarted();
     void searchProgressed(const QString &currentFile);
-    void searchFinished(int resultCount, int fileCount);
+    void searchFinished(int resultCount, int fileCount, bool hasMore);
+    void searchFailed(const QString &error);
 
     void replaceStarted();
     void replaceProgressed(const QString &currentFile);
@@ -106,6 +161,8 @@ private:
     SearchModelWorker worker;
 
     QList<SearchResultFile *> resultFiles;
+    QHash<QString, int> resultFileRows;
+    mutable SearchLineCache lineCache;
     int totalResults = 0;
     int totalResultFiles = 0;
 
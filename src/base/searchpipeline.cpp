@@ -0,0 +1,139 @@
+#include "base/searchpipeline.h"
+
+// SearchFileQueue
+
+bool SearchFileQueue::push(const QString &filePath)
+{
+    QMutexLocker locker(&mutex);
+    while (!closed && entries.count() >= capacity) {
+        notFull.wait(&mutex);
+    }
+    if (closed) {
+        return false;
+    }
+    entries.enqueue({nextSequence++, filePath});
+    notEmpty.wakeOne();
+    return true;
+}
+
+bool SearchFileQueue::pop(int &sequence, QString &filePath)
+{
+    QMutexLocker locker(&mutex);
+    while (!closed && entries.isEmpty()) {
+        notEmpty.wait(&mutex);
+    }
+    if (entries.isEmpty()) {
+        return false;
+    }
+    const Entry entry = entries.dequeue();
+    sequence = entry.sequence;
+    filePath = entry.filePath;
+    notFull.wakeOne();
+    return true;
+}
+
+void SearchFileQueue::close()
+{
+    QMutexLocker locker(&mutex);
+    closed = true;
+    notEmpty.wakeAll();
+    notFull.wakeAll();
+}
+
+// SearchResultSequencer
+
+void SearchResultSequencer::complete(int sequence, const SearchFileMatches &fileMatches)
+{
+    QMutexLocker locker(&mutex);
+    // The file expected next is never blocked, so the waiting scanners are always released:
+    while (!stopped && sequence != nextSequence && pending.count() >= capacity) {
+        notFull.wait(&mutex);
+    }
+    if (stopped) {
+        return;
+    }
+    pending.insert(sequence, fileMatches);
+
+    // Deliver the contiguous run of completed files that directly follows the last delivered one:
+    auto it = pending.begin();
+    while (!stopped && it != pending.end() && it.key() == nextSequence) {
+        const bool accepted = it.value().matches.isEmpty() || deliver(it.value());
+        it = pending.erase(it);
+        ++nextSequence;
+        stopped = !accepted;
+    }
+    notFull.wakeAll();
+}
+
+int SearchResultSequencer::stop()
+{
+    // Returns the number of files delivered so far, i.e. the walk position to resume from:
+    QMutexLocker locker(&mutex);
+    stopped = true;
+    pending.clear();
+    notFull.wakeAll();
+    return nextSequence;
+}
+
+bool SearchResultSequencer::isStopped()
+{
+    QMutexLocker locker(&mutex);
+    return stopped;
+}
+
+// SearchResultBatcher
+
+SearchResultBatcher::SearchResultBatcher(int maxMatches, int maxInterval,
+                                         const std::function<void(const QVector<SearchFileMatches> &)> &deliver)
+    : deliver(deliver)
+    , maxMatches(maxMatches)
+    , maxInterval(maxInterval)
+{
+    timer.start();
+}
+
+void SearchResultBatcher::add(const SearchFileMatches &fileMatches)
+{
+    QMutexLocker locker(&mutex);
+    batch.append(fileMatches);
+    batchMatches += fileMatches.matches.count();
+    if (batchMatches >= maxMatches || timer.elapsed() >= maxInterval) {
+        flushLocked();
+    }
+}
+
+void SearchResultBatcher::flushIfDue()
+{
+    QMutexLocker locker(&mutex);
+    if (timer.elapsed() >= maxInterval) {
+        flushLocked();
+    }
+}
+
+void SearchResultBatcher::flush()
+{
+    QMutexLocker locker(&mutex);
+    flushLocked();
+}
+
+void SearchResultBatcher::flushLocked()
+{
+    if (!batch.isEmpty()) {
+        deliver(batch);
+        batch.clear();
+        batchMatches = 0;
+    }
+    timer.restart();
+}
+
+// SearchProgressThrottle
+
+bool SearchProgressThrottle::isDue()
+{
+    QMutexLocker locker(&mutex);
+    if (timer.isValid() && timer.elapsed() < interval) {
+        return false;
+    }
+    timer.start();
+    return true;
+}
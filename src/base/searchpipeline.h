@@ -0,0 +1,121 @@
+#ifndef SEARCHPIPELINE_H
+#define SEARCHPIPELINE_H
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMetaType>
+#include <QMutex>
+#include <QQueue>
+#include <QVector>
+#include <QWaitCondition>
+#include <functional>
+
+struct SearchMatch
+{
+    QString lineContent;
+    int lineNumber;
+    int matchStart;
+    int matchLength;
+};
+
+struct SearchFileMatches
+{
+    QString filePath;
+    QVector<SearchMatch> matches;
+    bool truncated; // More matches than the per-file limit
+};
+
+Q_DECLARE_METATYPE(SearchFileMatches)
+
+// Bounded queue of file paths shared between the directory walker and the file scanners.
+// Every path is tagged with its position in the walk order.
+
+class SearchFileQueue
+{
+public:
+    explicit SearchFileQueue(int capacity = 1024) : capacity(capacity) {}
+
+    bool push(const QString &filePath);
+    bool pop(int &sequence, QString &filePath);
+    void close();
+
+private:
+    struct Entry
+    {
+        int sequence;
+        QString filePath;
+    };
+
+    QMutex mutex;
+    QWaitCondition notEmpty;
+    QWaitCondition notFull;
+    QQueue<Entry> entries;
+    const int capacity;
+    int nextSequence = 0;
+    bool closed = false;
+};
+
+// Collects the scanned files in any order and delivers them in the walk order.
+// Scanners running ahead of a slow file are blocked once the number of pending files reaches the capacity.
+// Delivery stops once the callback returns false or stop() is called.
+
+class SearchResultSequencer
+{
+public:
+    explicit SearchResultSequencer(const std::function<bool(const SearchFileMatches &)> &deliver, int capacity = 256)
+        : deliver(deliver), capacity(capacity) {}
+
+    void complete(int sequence, const SearchFileMatches &fileMatches);
+    int stop();
+    bool isStopped();
+
+private:
+    std::function<bool(const SearchFileMatches &)> deliver;
+    QMutex mutex;
+    QWaitCondition notFull;
+    QMap<int, SearchFileMatches> pending;
+    const int capacity;
+    int nextSequence = 0;
+    bool stopped = false;
+};
+
+// Accumulates per-file results and flushes them in batches bounded by match count and time.
+
+class SearchResultBatcher
+{
+public:
+    SearchResultBatcher(int maxMatches, int maxInterval,
+                        const std::function<void(const QVector<SearchFileMatches> &)> &deliver);
+
+    void add(const SearchFileMatches &fileMatches);
+    void flushIfDue();
+    void flush();
+
+private:
+    void flushLocked();
+
+    std::function<void(const QVector<SearchFileMatches> &)> deliver;
+    QMutex mutex;
+    QVector<SearchFileMatches> batch;
+    QElapsedTimer timer;
+    const int maxMatches;
+    const int maxInterval;
+    int batchMatches = 0;
+};
+
+// Limits the rate of progress notifications coming from several threads.
+
+class SearchProgressThrottle
+{
+public:
+    explicit SearchProgressThrottle(int interval) : interval(interval) {}
+
+    bool isDue();
+
+private:
+    QMutex mutex;
+    QElapsedTimer timer;
+    const int interval;
+};
+
+#endif // SEARCHPIPELINE_H
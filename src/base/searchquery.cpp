@@ -0,0 +1,158 @@
+#include "base/searchquery.h"
+#include <cstring>
+
+namespace
+{
+    inline char toLowerAscii(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+    }
+
+    inline char toUpperAscii(char c)
+    {
+        return (c >= 'a' && c <= 'z') ? char(c - ('a' - 'A')) : c;
+    }
+
+    inline bool equalsFolded(const char *haystack, const char *needle, int length)
+    {
+        for (int i = 0; i < length; ++i) {
+            if (toLowerAscii(haystack[i]) != needle[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool isAscii(const QString &string)
+    {
+        for (const QChar &c : string) {
+            if (c.unicode() >= 0x80) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+SearchQuery::SearchQuery(const QString &pattern, bool caseSensitive, bool byRegex)
+    : text(pattern)
+    , caseSensitivity(caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive)
+    , byRegex(byRegex)
+{
+    if (!byRegex) {
+        // Case-insensitive byte search only folds ASCII, so non-ASCII patterns need the text path:
+        byteSearchable = caseSensitive || isAscii(pattern);
+        bytes = caseSensitive ? pattern.toUtf8() : pattern.toUtf8().toLower();
+        return;
+    }
+
+    regex.setPattern(pattern);
+    if (!caseSensitive) {
+        regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+    }
+    if (!regex.isValid()) {
+        return;
+    }
+
+    // Compile the pattern (including JIT) right away instead of on the first match:
+    regex.optimize();
+
+    // Highlight the first capturing group if there is one, otherwise the whole match:
+    capturedGroup = regex.captureCount() > 0 ? 1 : 0;
+}
+
+bool SearchQuery::isValid() const
+{
+    if (text.isEmpty()) {
+        return false;
+    }
+    return !byRegex || regex.isValid();
+}
+
+QString SearchQuery::errorString() const
+{
+    return byRegex ? regex.errorString() : QString();
+}
+
+QString SearchQuery::pattern() const
+{
+    return text;
+}
+
+bool SearchQuery::isCaseSensitive() const
+{
+    return caseSensitivity == Qt::CaseSensitive;
+}
+
+bool SearchQuery::isRegex() const
+{
+    return byRegex;
+}
+
+bool SearchQuery::isByteSearchable() const
+{
+    return byteSearchable;
+}
+
+bool SearchQuery::match(const QString &line, int offset, int &matchStart, int &matchLength) const
+{
+    if (!byRegex) {
+        matchStart = line.indexOf(text, offset, caseSensitivity);
+        matchLength = text.length();
+        return matchStart != -1;
+    }
+
+    while (offset <= line.length()) {
+        const auto match = regex.match(line, offset);
+        if (!match.hasMatch()) {
+            return false;
+        }
+        matchStart = match.capturedStart(capturedGroup);
+        matchLength = match.capturedLength(capturedGroup);
+        if (matchStart != -1 && matchLength > 0) {
+            return true;
+        }
+        // Skip empty (or non-participating group) matches to guarantee progress:
+        offset = qMax(match.capturedEnd(0), offset + 1);
+    }
+    return false;
+}
+
+int SearchQuery::findIn(const char *data, int size, int from) const
+{
+    const int length = bytes.size();
+    if (!byteSearchable || length == 0 || from < 0 || from > size - length) {
+        return -1;
+    }
+
+    // Jump between the occurrences of the first pattern byte (in both cases) with memchr,
+    // which is vectorized by the C library, and verify the rest of the pattern in place:
+
+    const char *needle = bytes.constData();
+    const char *end = data + size - length + 1;
+    const bool caseSensitive = isCaseSensitive();
+    const char lower = needle[0];
+    const char upper = caseSensitive ? lower : toUpperAscii(lower);
+
+    auto find = [end](const char *position, char c) -> const char * {
+        return position < end ? static_cast<const char *>(std::memchr(position, c, end - position)) : nullptr;
+    };
+
+    const char *nextLower = find(data + from, lower);
+    const char *nextUpper = upper != lower ? find(data + from, upper) : nullptr;
+    while (nextLower || nextUpper) {
+        const char *candidate = (nextLower && (!nextUpper || nextLower < nextUpper)) ? nextLower : nextUpper;
+        const bool equal = caseSensitive
+            ? std::memcmp(candidate + 1, needle + 1, length - 1) == 0
+            : equalsFolded(candidate + 1, needle + 1, length - 1);
+        if (equal) {
+            return static_cast<int>(candidate - data);
+        }
+        if (candidate == nextLower) {
+            nextLower = find(candidate + 1, lower);
+        } else {
+            nextUpper = find(candidate + 1, upper);
+        }
+    }
+    return -1;
+}
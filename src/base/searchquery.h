@@ -0,0 +1,35 @@
+#ifndef SEARCHQUERY_H
+#define SEARCHQUERY_H
+
+#include <QRegularExpression>
+
+// Search query compiled once per search and shared read-only between the file scanners.
+
+class SearchQuery
+{
+public:
+    SearchQuery(const QString &pattern, bool caseSensitive, bool byRegex);
+
+    bool isValid() const;
+    QString errorString() const;
+    QString pattern() const;
+    bool isCaseSensitive() const;
+    bool isRegex() const;
+    bool isByteSearchable() const;
+
+    bool match(const QString &line, int offset, int &matchStart, int &matchLength) const;
+    int findIn(const char *data, int size, int from) const;
+
+private:
+    QString text;
+    Qt::CaseSensitivity caseSensitivity;
+    bool byRegex;
+    QRegularExpression regex;
+    int capturedGroup = 0;
+
+    // UTF-8 pattern for literal searches (ASCII-lowercased if case-insensitive):
+    QByteArray bytes;
+    bool byteSearchable = false;
+};
+
+#endif // SEARCHQUERY_H
@@ -1,38 +1,27 @@
 #include "base/searchresult.h"
+#include <QFile>
+#include <QSet>
+#include <QTextCodec>
 
-SearchResult::SearchResult(const QString &filePath, const QString &lineContent,
-                           int lineNumber, int matchStart, int matchLength)
-    : filePath(filePath)
-    , lineContent(lineContent)
-    , lineNumber(lineNumber)
-    , matchStart(matchStart)
-    , matchLength(matchLength)
-{}
+// SearchResult
 
-QString SearchResult::match() const
+bool SearchResult::matches(const QString &line) const
 {
-    return lineContent.mid(matchStart, matchLength);
+    return matchStart + matchLength <= line.length()
+        && line.midRef(matchStart, matchLength) == matchText;
 }
 
-bool SearchResult::matches(const QString &otherLine) const
-{
-    return match() == otherLine.mid(matchStart, matchLength);
-}
-
-SearchResultFile::~SearchResultFile()
-{
-    qDeleteAll(results);
-}
+// SearchResultFile
 
 Qt::CheckState SearchResultFile::getCheckState() const
 {
     bool hasCheckedItems = false;
     bool hasUncheckedItems = false;
 
-    for (const auto *result : results) {
-        if (result->checkState == Qt::Checked) {
+    for (const auto &result : results) {
+        if (result.checkState == Qt::Checked) {
             hasCheckedItems = true;
-        } else if (result->checkState == Qt::Unchecked) {
+        } else if (result.checkState == Qt::Unchecked) {
             hasUncheckedItems = true;
         }
 
@@ -50,12 +39,93 @@ int SearchResultFile::lastLineNumberLength() const
     if (results.isEmpty()) {
         return 0;
     }
-    return QString::number(results.last()->lineNumber).length();
+    return QString::number(results.last().lineNumber).length();
 }
 
 void SearchResultFile::setCheckState(Qt::CheckState state)
 {
     for (auto &result : results) {
-        result->checkState = state;
+        result.checkState = state;
+    }
+}
+
+// SearchLineCache
+
+SearchLineCache::SearchLineCache(int capacity) : capacity(capacity) {}
+
+QString SearchLineCache::line(const SearchResultFile *resultFile, int lineNumber)
+{
+    const QString &filePath = resultFile->path;
+    auto it = files.find(filePath);
+    if (it != files.end() && it.value().contains(lineNumber)) {
+        recentFiles.removeOne(filePath);
+        recentFiles.append(filePath);
+        return it.value().value(lineNumber);
+    }
+
+    // (Re)load the lines of the file which contain search results:
+    if (it == files.end()) {
+        if (files.count() >= capacity && !recentFiles.isEmpty()) {
+            files.remove(recentFiles.takeFirst());
+        }
+        it = files.insert(filePath, load(resultFile));
+    } else {
+        it.value() = load(resultFile);
+        recentFiles.removeOne(filePath);
+    }
+    recentFiles.append(filePath);
+    // Lines missing from the modified file are remembered as empty to avoid reloading it on every repaint:
+    return *it.value().insert(lineNumber, it.value().value(lineNumber));
+}
+
+void SearchLineCache::invalidate(const QString &filePath)
+{
+    files.remove(filePath);
+    recentFiles.removeOne(filePath);
+}
+
+void SearchLineCache::clear()
+{
+    files.clear();
+    recentFiles.clear();
+}
+
+QHash<int, QString> SearchLineCache::load(const SearchResultFile *resultFile)
+{
+    QHash<int, QString> lines;
+
+    QSet<int> lineNumbers;
+    for (const auto &result : resultFile->results) {
+        lineNumbers.insert(result.lineNumber);
+    }
+    if (lineNumbers.isEmpty()) {
+        return lines;
+    }
+
+    QFile file(resultFile->path);
+    if (!file.open(QFile::ReadOnly)) {
+        return lines;
+    }
+    const QByteArray data = file.readAll();
+    QTextCodec *codec = QTextCodec::codecForUtfText(data, QTextCodec::codecForName("UTF-8"));
+    const QString text = codec->toUnicode(data);
+
+    int lineStart = 0;
+    int lineNumber = 1;
+    while (lineStart <= text.size() && lines.count() < lineNumbers.count()) {
+        int lineEnd = text.indexOf('\n', lineStart);
+        const int nextLineStart = lineEnd == -1 ? text.size() + 1 : lineEnd + 1;
+        if (lineEnd == -1) {
+            lineEnd = text.size();
+        }
+        if (lineNumbers.contains(lineNumber)) {
+            if (lineEnd > lineStart && text.at(lineEnd - 1) == '\r') {
+                --lineEnd;
+            }
+            lines.insert(lineNumber, text.mid(lineStart, lineEnd - lineStart));
+        }
+        lineStart = nextLineStart;
+        ++lineNumber;
     }
+    return lines;
 }
@@ -1,28 +1,32 @@
 #ifndef SEARCHRESULT_H
 #define SEARCHRESULT_H
 
+#include <QHash>
 #include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+// Search results don't hold the line text: it is loaded on demand through SearchLineCache.
+// The matched text is kept to verify the match before replacing (equal matches share the same string data).
 
 struct SearchResult
 {
-    SearchResult(const QString &filePath, const QString &lineContent,
-                 int lineNumber, int matchStart, int matchLength);
-
-    QString match() const;
-    bool matches(const QString &otherLine) const;
+    bool matches(const QString &line) const;
 
-    QString filePath;
-    QString lineContent;
     int lineNumber;
     int matchStart;
     int matchLength;
-    Qt::CheckState checkState = Qt::Checked;
+    QString matchText;
+    Qt::CheckState checkState;
 };
 
+Q_DECLARE_TYPEINFO(SearchResult, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(SearchResult)
+
 struct SearchResultFile
 {
     SearchResultFile(const QString &path) : path(path) {}
-    ~SearchResultFile();
 
     Qt::CheckState getCheckState() const;
     int lastLineNumberLength() const;
@@ -30,7 +34,27 @@ struct SearchResultFile
     void setCheckState(Qt::CheckState state);
 
     const QString path;
-    QList<SearchResult *> results;
+    QVector<SearchResult> results;
+    bool truncated = false;
+};
+
+Q_DECLARE_METATYPE(SearchResultFile *)
+
+class SearchLineCache
+{
+public:
+    explicit SearchLineCache(int capacity = 32);
+
+    QString line(const SearchResultFile *resultFile, int lineNumber);
+    void invalidate(const QString &filePath);
+    void clear();
+
+private:
+    static QHash<int, QString> load(const SearchResultFile *resultFile);
+
+    const int capacity;
+    QHash<QString, QHash<int, QString>> files;
+    QList<QString> recentFiles;
 };
 
 #endif // SEARCHRESULT_H
@@ -0,0 +1,110 @@
+#include "base/searchscope.h"
+
+void SearchScope::setDirectories(const QString &patterns)
+{
+    directories.clear();
+    for (const QString &pattern : splitPatterns(patterns)) {
+        // Every path segment is matched separately, so that the walker can prune the tree level by level:
+        QVector<QRegularExpression> segments;
+        for (const QString &segment : pattern.split('/', Qt::SkipEmptyParts)) {
+            segments.append(compileGlob(segment));
+        }
+        if (!segments.isEmpty()) {
+            directories.append(segments);
+        }
+    }
+}
+
+void SearchScope::setIncludePatterns(const QString &patterns)
+{
+    includes.clear();
+    for (const QString &pattern : splitPatterns(patterns)) {
+        includes.append(compilePattern(pattern));
+    }
+}
+
+void SearchScope::setExcludePatterns(const QString &patterns)
+{
+    excludes.clear();
+    for (const QString &pattern : splitPatterns(patterns)) {
+        excludes.append(compilePattern(pattern));
+    }
+}
+
+SearchScope::DirectoryMatch SearchScope::matchDirectory(const QString &relativePath) const
+{
+    if (!relativePath.isEmpty() && matchesAny(excludes, relativePath)) {
+        return DirectoryExcluded;
+    }
+    if (directories.isEmpty()) {
+        return DirectoryIncluded;
+    }
+
+    const QStringList segments = relativePath.split('/', Qt::SkipEmptyParts);
+    bool isOnPath = false;
+    for (const auto &directory : directories) {
+        const int depth = qMin(segments.count(), directory.count());
+        int segment = 0;
+        while (segment < depth && directory.at(segment).match(segments.at(segment)).hasMatch()) {
+            ++segment;
+        }
+        if (segment == depth) {
+            if (segments.count() >= directory.count()) {
+                return DirectoryIncluded;
+            }
+            isOnPath = true;
+        }
+    }
+    return isOnPath ? DirectoryOnPath : DirectoryExcluded;
+}
+
+bool SearchScope::matchFile(const QString &relativePath) const
+{
+    if (matchesAny(excludes, relativePath)) {
+        return false;
+    }
+    return includes.isEmpty() || matchesAny(includes, relativePath);
+}
+
+QStringList SearchScope::splitPatterns(const QString &patterns)
+{
+    QStringList result;
+    for (const QString &pattern : patterns.split(',', Qt::SkipEmptyParts)) {
+        const QString trimmed = pattern.trimmed();
+        if (!trimmed.isEmpty()) {
+            result.append(trimmed);
+        }
+    }
+    return result;
+}
+
+SearchScope::Pattern SearchScope::compilePattern(const QString &pattern)
+{
+    QString glob = pattern;
+    while (glob.startsWith('/')) {
+        glob.remove(0, 1);
+    }
+    while (glob.endsWith('/')) {
+        glob.chop(1);
+    }
+    return {compileGlob(glob), pattern.contains('/')};
+}
+
+QRegularExpression SearchScope::compileGlob(const QString &glob)
+{
+    QRegularExpression regex(QRegularExpression::wildcardToRegularExpression(glob),
+                             QRegularExpression::CaseInsensitiveOption);
+    regex.optimize();
+    return regex;
+}
+
+bool SearchScope::matchesAny(const QVector<Pattern> &patterns, const QString &relativePath)
+{
+    const QString name = relativePath.mid(relativePath.lastIndexOf('/') + 1);
+    for (const auto &pattern : patterns) {
+        if (pattern.regex.match(pattern.byPath ? relativePath : name).hasMatch()) {
+            return true;
+        }
+    }
+    return false;
+}
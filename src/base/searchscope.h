@@ -0,0 +1,44 @@
+#ifndef SEARCHSCOPE_H
+#define SEARCHSCOPE_H
+
+#include <QRegularExpression>
+#include <QVector>
+
+// Restricts the project search to a set of directories and file patterns.
+// Patterns are comma-separated globs. A pattern containing a slash is matched against the path relative
+// to the search root (a leading slash is optional), any other pattern against the file or directory name.
+
+class SearchScope
+{
+public:
+    enum DirectoryMatch {
+        DirectoryExcluded,
+        DirectoryOnPath,
+        DirectoryIncluded,
+    };
+
+    void setDirectories(const QString &patterns);
+    void setIncludePatterns(const QString &patterns);
+    void setExcludePatterns(const QString &patterns);
+
+    DirectoryMatch matchDirectory(const QString &relativePath) const;
+    bool matchFile(const QString &relativePath) const;
+
+private:
+    struct Pattern
+    {
+        QRegularExpression regex;
+        bool byPath;
+    };
+
+    static QStringList splitPatterns(const QString &patterns);
+    static Pattern compilePattern(const QString &pattern);
+    static QRegularExpression compileGlob(const QString &glob);
+    static bool matchesAny(const QVector<Pattern> &patterns, const QString &relativePath);
+
+    QVector<QVector<QRegularExpression>> directories;
+    QVector<Pattern> includes;
+    QVector<Pattern> excludes;
+};
+
+#endif // SEARCHSCOPE_H
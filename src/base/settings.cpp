@@ -237,6 +237,36 @@ bool Settings::getSearchByRegex() const
     return settings->value("CodeEditor/SearchByRegex", false).toBool();
 }
 
+int Settings::getSearchMaxResults() const
+{
+    return settings->value("CodeEditor/SearchMaxResults", 5000).toInt();
+}
+
+int Settings::getSearchMaxFileResults() const
+{
+    return settings->value("CodeEditor/SearchMaxFileResults", 500).toInt();
+}
+
+int Settings::getSearchTimeLimit() const
+{
+    return settings->value("CodeEditor/SearchTimeLimit", 30).toInt();
+}
+
+QString Settings::getSearchDirectories() const
+{
+    return settings->value("CodeEditor/SearchDirectories").toString();
+}
+
+QString Settings::getSearchInclude() const
+{
+    return settings->value("CodeEditor/SearchInclude").toString();
+}
+
+QString Settings::getSearchExclude() const
+{
+    return settings->value("CodeEditor/SearchExclude", "/original, /build").toString();
+}
+
 QString Settings::getTheme() const
 {
     return settings->value("Appearance/Theme", "system").toString();
@@ -509,6 +539,36 @@ void Settings::setSearchByRegex(bool enabled) const
     settings->setValue("CodeEditor/SearchByRegex", enabled);
 }
 
+void Settings::setSearchMaxResults(int limit) const
+{
+    settings->setValue("CodeEditor/SearchMaxResults", limit);
+}
+
+void Settings::setSearchMaxFileResults(int limit) const
+{
+    settings->setValue("CodeEditor/SearchMaxFileResults", limit);
+}
+
+void Settings::setSearchTimeLimit(int seconds) const
+{
+    settings->setValue("CodeEditor/SearchTimeLimit", seconds);
+}
+
+void Settings::setSearchDirectories(const QString &patterns) const
+{
+    settings->setValue("CodeEditor/SearchDirectories", patterns);
+}
+
+void Settings::setSearchInclude(const QString &patterns) const
+{
+    settings->setValue("CodeEditor/SearchInclude", patterns);
+}
+
+void Settings::setSearchExclude(const QString &patterns) const
+{
+    settings->setValue("CodeEditor/SearchExclude", patterns);
+}
+
 void Settings::setTheme(const QString &theme)
 {
     settings->setValue("Appearance/Theme", theme);
@@ -53,6 +53,12 @@ public:
     QByteArray getFileSystemTreeHeader() const;
     bool getSearchCaseSensitive() const;
     bool getSearchByRegex() const;
+    int getSearchMaxResults() const;
+    int getSearchMaxFileResults() const;
+    int getSearchTimeLimit() const;
+    QString getSearchDirectories() const;
+    QString getSearchInclude() const;
+    QString getSearchExclude() const;
     QString getTheme() const;
     QStringList getAndroidExplorerToolbar() const;
     QByteArray getAndroidExplorerGeometry() const;
@@ -106,6 +112,12 @@ public:
     void setFileSystemTreeHeader(const QByteArray &state) const;
     void setSearchCaseSensitive(bool enabled) const;
     void setSearchByRegex(bool enabled) const;
+    void setSearchMaxResults(int limit) const;
+    void setSearchMaxFileResults(int limit) const;
+    void setSearchTimeLimit(int seconds) const;
+    void setSearchDirectories(const QString &patterns) const;
+    void setSearchInclude(const QString &patterns) const;
+    void setSearchExclude(const QString &patterns) const;
     void setTheme(const QString &theme);
     void setAndroidExplorerToolbar(const QStringList &actions);
     void setAndroidExplorerGeometry(const QByteArray &geometry);
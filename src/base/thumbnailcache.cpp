@@ -0,0 +1,86 @@
+#include "base/thumbnailcache.h"
+#include <QImageReader>
+#include <QtConcurrent/QtConcurrent>
+
+ThumbnailCache::ThumbnailCache(const QSize &size, int capacity, QObject *parent)
+    : QObject(parent)
+    , size(size)
+    , capacity(capacity)
+{
+    // Leave a core for the GUI thread:
+    pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    pool.clear();
+    pool.waitForDone();
+}
+
+QPixmap ThumbnailCache::thumbnail(const QString &path)
+{
+    auto it = thumbnails.constFind(path);
+    if (it != thumbnails.constEnd()) {
+        recentPaths.removeOne(path);
+        recentPaths.append(path);
+        return it.value();
+    }
+    request(path);
+    return QPixmap();
+}
+
+void ThumbnailCache::invalidate(const QString &path)
+{
+    thumbnails.remove(path);
+    recentPaths.removeOne(path);
+    // Discard the result of a decode which might have read the previous contents:
+    pendingRequests.remove(path);
+}
+
+void ThumbnailCache::clear()
+{
+    pool.clear();
+    thumbnails.clear();
+    recentPaths.clear();
+    pendingRequests.clear();
+}
+
+QImage ThumbnailCache::decode(const QString &path, const QSize &size)
+{
+    QImageReader reader(path);
+    const QSize imageSize = reader.size();
+    if (imageSize.isValid() && (imageSize.width() > size.width() || imageSize.height() > size.height())) {
+        // Let the image handler downscale while decoding whenever it supports it:
+        reader.setScaledSize(imageSize.scaled(size, Qt::KeepAspectRatio));
+    }
+    return reader.read();
+}
+
+void ThumbnailCache::request(const QString &path)
+{
+    if (pendingRequests.contains(path)) {
+        return;
+    }
+    const quint64 requestId = ++lastRequest;
+    pendingRequests.insert(path, requestId);
+
+    const QSize size = this->size;
+    QtConcurrent::run(&pool, [=]() {
+        const QImage image = decode(path, size);
+        // Pixmaps can only be created in the GUI thread:
+        QMetaObject::invokeMethod(this, [=]() {
+            if (pendingRequests.value(path) != requestId) {
+                return; // Cleared or invalidated in the meantime
+            }
+            pendingRequests.remove(path);
+            if (!thumbnails.contains(path)) {
+                if (thumbnails.count() >= capacity && !recentPaths.isEmpty()) {
+                    thumbnails.remove(recentPaths.takeFirst());
+                }
+                recentPaths.append(path);
+            }
+            thumbnails.insert(path, QPixmap::fromImage(image));
+            emit thumbnailReady(path);
+        }, Qt::QueuedConnection);
+    });
+}
@@ -0,0 +1,41 @@
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QThreadPool>
+
+// Decodes image thumbnails on a background thread pool and keeps the most recently used ones.
+// Entries are keyed by the file path and have to be invalidated whenever the file is written.
+
+class ThumbnailCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ThumbnailCache(const QSize &size, int capacity = 512, QObject *parent = nullptr);
+    ~ThumbnailCache() override;
+
+    QPixmap thumbnail(const QString &path);
+    void invalidate(const QString &path);
+    void clear();
+
+signals:
+    void thumbnailReady(const QString &path);
+
+private:
+    static QImage decode(const QString &path, const QSize &size);
+    void request(const QString &path);
+
+    const QSize size;
+    const int capacity;
+    QHash<QString, QPixmap> thumbnails;
+    QList<QString> recentPaths;
+    QHash<QString, quint64> pendingRequests;
+    quint64 lastRequest = 0;
+    QThreadPool pool;
+};
+
+#endif // THUMBNAILCACHE_H
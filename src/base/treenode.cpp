@@ -8,12 +8,13 @@ TreeNode::~TreeNode()
 void TreeNode::addChild(TreeNode *node)
 {
     node->parent = this;
+    node->cachedRow = children.count();
     children.append(node);
 }
 
 bool TreeNode::hasChild(TreeNode *node) const
 {
-    return children.contains(node);
+    return node && node->parent == this;
 }
 
 bool TreeNode::hasChildren() const
@@ -61,5 +62,19 @@ QVector<TreeNode *> &TreeNode::getChildren()
 
 int TreeNode::row() const
 {
-    return parent ? parent->children.indexOf(const_cast<TreeNode *>(this)) : 0;
+    if (!parent) {
+        return 0;
+    }
+    const auto &siblings = parent->children;
+    if (cachedRow >= siblings.count() || siblings.at(cachedRow) != this) {
+        parent->updateRows();
+    }
+    return cachedRow;
+}
+
+void TreeNode::updateRows() const
+{
+    for (int row = 0; row < children.count(); ++row) {
+        children.at(row)->cachedRow = row;
+    }
 }
@@ -6,7 +6,7 @@
 class TreeNode
 {
 public:
-    TreeNode() : parent(nullptr) {}
+    TreeNode() : parent(nullptr), cachedRow(0) {}
     virtual ~TreeNode();
 
     void addChild(TreeNode *node);
@@ -27,6 +27,13 @@ public:
 protected:
     TreeNode *parent;
     QVector<TreeNode *> children;
+
+private:
+    void updateRows() const;
+
+    // Row index within the parent, validated against the parent's children on every lookup
+    // and recalculated for all siblings at once after they were inserted, removed or reordered:
+    mutable int cachedRow;
 };
 
 
@@ -63,6 +63,11 @@ bool BaseFileSheet::explore() const
     return index.explore();
 }
 
+QString BaseFileSheet::getFilePath() const
+{
+    return index.path();
+}
+
 void BaseFileSheet::changeEvent(QEvent *event)
 {
     if (event->type() == QEvent::LanguageChange) {
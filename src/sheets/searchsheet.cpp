@@ -3,6 +3,7 @@
 #include "widgets/searchresultview.h"
 #include "base/application.h"
 #include "base/searchmodel.h"
+#include "base/searchscope.h"
 #include "base/settings.h"
 #include <QAction>
 #include <QDir>
@@ -19,8 +20,10 @@ SearchSheet::SearchSheet(QWidget *parent) : BaseSheet(parent)
     setSheetIcon(QIcon::fromTheme("edit-find"));
 
     searchModel = new SearchModel(this);
-    connect(searchModel, &SearchModel::searchProgressed, this, [this]() {
-        resultsView->expand(searchModel->index(0, 0));
+    connect(searchModel, &SearchModel::rowsInserted, this, [this](const QModelIndex &parent) {
+        if (!parent.isValid()) {
+            resultsView->expand(searchModel->index(0, 0));
+        }
     });
 
     searchLabel = new QLabel(this);
@@ -32,6 +35,8 @@ SearchSheet::SearchSheet(QWidget *parent) : BaseSheet(parent)
     searchStopButton->setFocusPolicy(Qt::TabFocus);
     connect(searchInput, &QLineEdit::returnPressed, searchButton, &QPushButton::click);
     connect(searchButton, &QPushButton::clicked, this, [this]() {
+        updateResultLimits();
+        updateSearchScope();
         searchModel->search(searchInput->text(), searchPath);
     });
     connect(searchStopButton, &QPushButton::clicked, this, [this]() {
@@ -82,9 +87,25 @@ SearchSheet::SearchSheet(QWidget *parent) : BaseSheet(parent)
     replaceLayout->addWidget(replaceButton);
     replaceLayout->addWidget(replaceStopButton);
 
+    scopeLabel = new QLabel(this);
+    directoriesInput = new QLineEdit(app->settings->getSearchDirectories(), this);
+    directoriesInput->setClearButtonEnabled(true);
+    includeInput = new QLineEdit(app->settings->getSearchInclude(), this);
+    includeInput->setClearButtonEnabled(true);
+    excludeInput = new QLineEdit(app->settings->getSearchExclude(), this);
+    excludeInput->setClearButtonEnabled(true);
+    for (auto input : {directoriesInput, includeInput, excludeInput}) {
+        connect(input, &QLineEdit::returnPressed, searchButton, &QPushButton::click);
+    }
+    auto scopeLayout = new QHBoxLayout;
+    scopeLayout->addWidget(directoriesInput);
+    scopeLayout->addWidget(includeInput);
+    scopeLayout->addWidget(excludeInput);
+
     auto controlsLayout = new QFormLayout;
     controlsLayout->addRow(searchLabel, searchLayout);
     controlsLayout->addRow(replaceLabel, replaceLayout);
+    controlsLayout->addRow(scopeLabel, scopeLayout);
 
     resultsView = new SearchResultView(this);
     resultsView->setModel(searchModel);
@@ -104,6 +125,16 @@ SearchSheet::SearchSheet(QWidget *parent) : BaseSheet(parent)
 
     statusLabel = new ElidedLabel(this);
     statusLabel->hide();
+    searchMoreButton = new QPushButton(this);
+    searchMoreButton->setFocusPolicy(Qt::TabFocus);
+    searchMoreButton->hide();
+    connect(searchMoreButton, &QPushButton::clicked, this, [this]() {
+        updateResultLimits();
+        searchModel->searchMore();
+    });
+    auto statusLayout = new QHBoxLayout;
+    statusLayout->addWidget(statusLabel, 1);
+    statusLayout->addWidget(searchMoreButton);
 
     connect(searchModel, &SearchModel::searchStarted, this, [this]() {
         updateState(StateSearching);
@@ -116,9 +147,16 @@ SearchSheet::SearchSheet(QWidget *parent) : BaseSheet(parent)
         statusLabel->setText(tr("Searching in %1").arg(currentSearchPath));
     });
 
-    connect(searchModel, &SearchModel::searchFinished, this, [this](int resultCount, int fileCount) {
+    connect(searchModel, &SearchModel::searchFinished, this, [this](int resultCount, int fileCount, bool hasMore) {
         updateState(StateIdle);
-        updateSearchStats(resultCount, fileCount);
+        updateSearchStats(resultCount, fileCount, hasMore);
+    });
+
+    connect(searchModel, &SearchModel::searchFailed, this, [this](const QString &error) {
+        // The worker has dropped the continuation of the previous search:
+        searchMoreButton->hide();
+        //: "%1" will be replaced with the error description.
+        QMessageBox::warning(this, {}, tr("Invalid regular expression: %1").arg(error));
     });
 
     connect(searchModel, &SearchModel::replaceStarted, this, [this]() {
@@ -143,7 +181,7 @@ SearchSheet::SearchSheet(QWidget *parent) : BaseSheet(parent)
     auto layout = new QVBoxLayout(this);
     layout->addLayout(controlsLayout);
     layout->addWidget(resultsView);
-    layout->addWidget(statusLabel);
+    layout->addLayout(statusLayout);
 
     updateState(StateIdle);
     retranslate();
@@ -162,6 +200,16 @@ void SearchSheet::setSearchPath(const QString &path)
     searchModel->setRootPath(searchPath);
 }
 
+void SearchSheet::setFileClassifier(SearchFileClassifier *classifier)
+{
+    searchModel->setFileClassifier(classifier);
+}
+
+void SearchSheet::setSearchIndex(SearchIndex *index)
+{
+    searchModel->setSearchIndex(index);
+}
+
 void SearchSheet::changeEvent(QEvent *event)
 {
     if (event->type() == QEvent::LanguageChange) {
@@ -189,16 +237,45 @@ void SearchSheet::updateState(State state)
     replaceStopButton->setEnabled(state == StateReplacing);
 
     resultsView->setEnabled(state != StateReplacing);
+
+    if (state != StateIdle) {
+        searchMoreButton->hide();
+    }
 }
 
-void SearchSheet::updateSearchStats(int resultCount, int fileCount)
+void SearchSheet::updateSearchStats(int resultCount, int fileCount, bool hasMore)
 {
-    if (resultCount) {
+    if (hasMore) {
+        //: "%1" and "%2" will be replaced with arbitrary numbers representing the search results.
+        statusLabel->setText(tr("Found %1 result(s) in %2 file(s), search limit reached").arg(resultCount).arg(fileCount));
+    } else if (resultCount) {
         //: "%1" and "%2" will be replaced with arbitrary numbers representing the search results.
         statusLabel->setText(tr("Found %1 result(s) in %2 file(s)").arg(resultCount).arg(fileCount));
     } else {
         statusLabel->setText(tr("No results found"));
     }
+    searchMoreButton->setVisible(hasMore);
+}
+
+void SearchSheet::updateResultLimits()
+{
+    searchModel->setResultLimits(
+        app->settings->getSearchMaxResults(),
+        app->settings->getSearchMaxFileResults(),
+        app->settings->getSearchTimeLimit() * 1000);
+}
+
+void SearchSheet::updateSearchScope()
+{
+    SearchScope scope;
+    scope.setDirectories(directoriesInput->text());
+    scope.setIncludePatterns(includeInput->text());
+    scope.setExcludePatterns(excludeInput->text());
+    searchModel->setSearchScope(scope);
+
+    app->settings->setSearchDirectories(directoriesInput->text());
+    app->settings->setSearchInclude(includeInput->text());
+    app->settings->setSearchExclude(excludeInput->text());
 }
 
 void SearchSheet::updateReplaceStats(int resultCount, int fileCount)
@@ -217,10 +294,18 @@ void SearchSheet::retranslate()
 
     searchLabel->setText(tr("Search for:"));
     replaceLabel->setText(tr("Replace with:"));
+    scopeLabel->setText(tr("Search in:"));
+    //: Comma-separated list of directory masks.
+    directoriesInput->setPlaceholderText(tr("Directories (e.g., res/values*, smali_classes3)"));
+    //: Comma-separated list of file masks.
+    includeInput->setPlaceholderText(tr("Files to include (e.g., *.xml)"));
+    //: Comma-separated list of file or directory masks.
+    excludeInput->setPlaceholderText(tr("Files to exclude (e.g., /original, /build)"));
 
     searchButton->setText(tr("&Search"));
     replaceButton->setText(tr("&Replace"));
 
     searchStopButton->setText(tr("Stop"));
     replaceStopButton->setText(tr("Stop"));
+    searchMoreButton->setText(tr("Show More"));
 }
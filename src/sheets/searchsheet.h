@@ -7,6 +7,8 @@ class ElidedLabel;
 class QLabel;
 class QLineEdit;
 class QPushButton;
+class SearchFileClassifier;
+class SearchIndex;
 class SearchModel;
 class SearchResultView;
 
@@ -19,6 +21,8 @@ public:
 
     bool finalize() override;
     void setSearchPath(const QString &path);
+    void setFileClassifier(SearchFileClassifier *classifier);
+    void setSearchIndex(SearchIndex *index);
 
 signals:
     void editRequested(const QString &filePath, int lineNumber, int columnNumber, int selectionLength);
@@ -35,7 +39,9 @@ private:
     };
 
     void updateState(State state);
-    void updateSearchStats(int resultCount, int fileCount);
+    void updateSearchStats(int resultCount, int fileCount, bool hasMore);
+    void updateResultLimits();
+    void updateSearchScope();
     void updateReplaceStats(int resultCount, int fileCount);
     void retranslate();
 
@@ -50,8 +56,13 @@ private:
     QLineEdit *replaceInput;
     QPushButton *replaceButton;
     QPushButton *replaceStopButton;
+    QLabel *scopeLabel;
+    QLineEdit *directoriesInput;
+    QLineEdit *includeInput;
+    QLineEdit *excludeInput;
     SearchResultView *resultsView;
     ElidedLabel *statusLabel;
+    QPushButton *searchMoreButton;
 };
 
 #endif // SEARCHSHEET_H
@@ -23,6 +23,7 @@
 #include <QPushButton>
 #include <QSpinBox>
 #include <QStackedWidget>
+#include <limits>
 
 #ifdef QT_DEBUG
     #include <QDebug>
@@ -67,6 +68,9 @@ void OptionsDialog::load()
     checkboxSingleInstance->setChecked(app->settings->getSingleInstance());
     checkboxUpdates->setChecked(app->settings->getAutoUpdates());
     spinboxRecent->setValue(app->settings->getRecentApkLimit());
+    spinboxSearchResults->setValue(app->settings->getSearchMaxResults());
+    spinboxSearchFileResults->setValue(app->settings->getSearchMaxFileResults());
+    spinboxSearchTime->setValue(app->settings->getSearchTimeLimit());
 #ifdef Q_OS_WIN
     groupAssociate->setChecked(app->settings->getFileAssociation());
     checkboxExplorerOpen->setChecked(app->settings->getExplorerOpenIntegration());
@@ -134,6 +138,9 @@ void OptionsDialog::save()
     app->settings->setSingleInstance(checkboxSingleInstance->isChecked());
     app->settings->setAutoUpdates(checkboxUpdates->isChecked());
     app->settings->setRecentApkLimit(spinboxRecent->value());
+    app->settings->setSearchMaxResults(spinboxSearchResults->value());
+    app->settings->setSearchMaxFileResults(spinboxSearchFileResults->value());
+    app->settings->setSearchTimeLimit(spinboxSearchTime->value());
 #ifdef Q_OS_WIN
     bool integrationSuccess =
         app->settings->setFileAssociation(groupAssociate->isChecked()) &&
@@ -221,12 +228,27 @@ void OptionsDialog::initialize()
     spinboxRecent = new QSpinBox(this);
     spinboxRecent->setMinimum(0);
     spinboxRecent->setMaximum(50);
+    spinboxSearchResults = new QSpinBox(this);
+    spinboxSearchResults->setRange(0, std::numeric_limits<int>::max());
+    //: Used as a spinbox value when no limit is set.
+    spinboxSearchResults->setSpecialValueText(tr("Unlimited"));
+    spinboxSearchFileResults = new QSpinBox(this);
+    spinboxSearchFileResults->setRange(0, std::numeric_limits<int>::max());
+    spinboxSearchFileResults->setSpecialValueText(tr("Unlimited"));
+    spinboxSearchTime = new QSpinBox(this);
+    spinboxSearchTime->setRange(0, 3600);
+    spinboxSearchTime->setSpecialValueText(tr("Unlimited"));
+    //: This is a unit of time (seconds). Keep the leading space.
+    spinboxSearchTime->setSuffix(tr(" s"));
 #ifdef Q_OS_MACOS
     checkboxSingleInstance->hide();
 #endif
     pageGeneral->addRow(checkboxSingleInstance);
     pageGeneral->addRow(checkboxUpdates);
     pageGeneral->addRow(tr("Maximum recent files:"), spinboxRecent);
+    pageGeneral->addRow(tr("Maximum search results:"), spinboxSearchResults);
+    pageGeneral->addRow(tr("Maximum search results per file:"), spinboxSearchFileResults);
+    pageGeneral->addRow(tr("Search time limit:"), spinboxSearchTime);
 
 #ifdef Q_OS_WIN
     //: Don't translate the "APK Editor Studio" and ".apk" parts.
@@ -39,6 +39,9 @@ private:
     QCheckBox *checkboxSingleInstance;
     QCheckBox *checkboxUpdates;
     QSpinBox *spinboxRecent;
+    QSpinBox *spinboxSearchResults;
+    QSpinBox *spinboxSearchFileResults;
+    QSpinBox *spinboxSearchTime;
 #ifdef Q_OS_WIN
     QGroupBox *groupAssociate;
     QCheckBox *checkboxExplorerOpen;